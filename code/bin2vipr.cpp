@@ -0,0 +1,124 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Converts a binary certificate written by vipr2bin back into the .vipr text format
+
+#include <iostream>
+#include <fstream>
+#include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+
+using namespace std;
+
+
+int main(int argc, char *argv[])
+{
+   int rs = -1;
+   Tokenizer binaryFile;
+   ofstream certificateFile;
+   string certificateFileName;
+   TokenView token;
+   bool lineStart = true;
+
+   if( argc != 2 && argc != 3 )
+   {
+      cerr << "Usage: " << argv[0] << " <binaryFile> [<certificateFile>]\n";
+      return rs;
+   }
+
+   binaryFile.open(argv[1]);
+
+   if( binaryFile.fail() )
+   {
+      cerr << "Failed to open file " << argv[1] << endl;
+      return rs;
+   }
+
+   if( !binaryFile.isBinary() )
+   {
+      cerr << argv[1] << " is not a binary certificate" << endl;
+      return rs;
+   }
+
+   if( argc == 3 )
+      certificateFileName = argv[2];
+   else
+   {
+      certificateFileName = stripCompressionSuffix(argv[1]);
+      if( certificateFileName.size() > 5 && certificateFileName.compare(certificateFileName.size() - 5, 5, ".vipb") == 0 )
+         certificateFileName.resize(certificateFileName.size() - 5);
+      certificateFileName += ".vipr";
+   }
+
+   certificateFile.open(certificateFileName.c_str());
+
+   if( certificateFile.fail() )
+   {
+      cerr << "Failed to open file " << certificateFileName << endl;
+      return rs;
+   }
+
+   // tokens are separated by single spaces, line breaks are kept
+   while( true )
+   {
+      int next = binaryFile.peek();
+
+      if( next == EOF )
+         break;
+
+      if( next == '\n' )
+      {
+         certificateFile << '\n';
+         binaryFile.ignore(1);
+         lineStart = true;
+         continue;
+      }
+
+      if( !binaryFile.nextToken(token) )
+         break;
+
+      if( !lineStart )
+         certificateFile << ' ';
+      certificateFile.write(token.data, token.size);
+      lineStart = false;
+   }
+
+   if( binaryFile.fail() && !binaryFile.eof() )
+   {
+      cerr << "Failed to read file " << argv[1] << endl;
+      return rs;
+   }
+
+   certificateFile.close();
+
+   if( certificateFile.fail() )
+   {
+      cerr << "Failed to write file " << certificateFileName << endl;
+      return rs;
+   }
+
+   rs = 0;
+
+   return rs;
+}
@@ -0,0 +1,1022 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+#include <gmpxx.h>
+#include "CMakeConfig.hpp"
+#include "certificate.hpp"
+
+
+// Avoid using namespace std to avoid non-obvious complications (ambiguities)
+using std::string;
+using std::shared_ptr;
+using std::vector;
+using std::make_shared;
+using std::endl;
+
+namespace vipr
+{
+
+const AssumptionSet emptyList;
+
+
+// Processes in order of appearance
+
+// Version control for .vipr input file. Backward compatibility possible for minor versions
+bool Certificate::checkVersion(string version)
+{
+   bool returnStatement = false;
+
+   size_t position = version.find(".");
+
+   int major = atoi(version.substr(0, position).c_str());
+   int minor = atoi(version.substr(position+1, version.length()-position).c_str());
+
+   out << "Certificate format version " << major << "." << minor << endl;
+
+   if( (major ==VIPR_VERSION_MAJOR) && (minor <=VIPR_VERSION_MINOR) )
+   {
+      returnStatement = true;
+   }
+   else
+   {
+      err << "Version unsupported" << endl;
+   }
+
+   return returnStatement;
+}
+
+
+// Check version and correct file format allows next process to start
+// Error if the version is incompatible or not specified
+bool Certificate::processVER()
+{
+   stats.startPhase("VER");
+
+   bool returnStatement = false;
+   string tmpStr;
+
+   for( ;; )
+   {
+      certificateFile >> tmpStr;
+      if( tmpStr == "VER" )
+      {
+         certificateFile >> tmpStr;
+         returnStatement = checkVersion(tmpStr);
+break;
+      }
+      else if( tmpStr == "%" )
+      {
+         getline(certificateFile, tmpStr);
+      }
+      else
+      {
+         err << endl << "Comment or VER expected. Read instead "
+                << tmpStr << endl;
+break;
+      }
+   }
+
+   return returnStatement;
+}
+
+
+// Processes number of variables then indexes them in order from 0 to n-1
+// Produces vector of variables
+// Error if nr of variables invalid or number of variables > specified variables or section missing
+bool Certificate::processVAR()
+{
+
+   out << endl << "Processing VAR section..." << endl;
+   stats.startPhase("VAR");
+
+   auto returnStatement = true;
+
+   string section;
+
+   certificateFile >> section;
+
+
+   // Check section
+   if( section != "VAR" )
+   {
+      err << "VAR expected.   Read instead " << section << endl;
+   }
+   else
+   {
+      certificateFile >> numberOfVariables; // number of variables
+
+      if( certificateFile.fail() || numberOfVariables < 0 )
+      {
+         err << "Invalid number after VAR" << endl;
+         returnStatement = false;
+      }
+
+
+      // Store variables
+      else
+      {
+         for( int i = 0; i < numberOfVariables; i++ )
+         {
+            string tmp;
+            certificateFile >> tmp;
+            if( certificateFile.fail() )
+            {
+               err << "Error reading variable for index " << i << endl;
+               returnStatement = false;
+         break;
+            }
+            variable.push_back(tmp);
+         }
+      }
+   }
+
+   return returnStatement;
+}
+
+
+// Processes number of integer variables and specifies their indices
+// Produces vector of indices of integer variables
+// Error if nr of integers invalid or nr of integers > specified integers or section missing
+bool Certificate::processINT()
+{
+   out << endl << "Processing INT section..." << endl;
+   stats.startPhase("INT");
+
+   bool returnStatement = false;
+
+   string section;
+
+   certificateFile >> section;
+
+
+   // Check section
+   if( section != "INT" )
+   {
+      err << "INT expected.   Read instead " << section << endl;
+   }
+   else
+   {
+      auto numberOfIntegers = 0;
+
+      certificateFile >> numberOfIntegers; // number of integer variables
+
+      if( certificateFile.fail() || numberOfIntegers < 0 )
+      {
+         err << "Invalid number after INT" << endl;
+      }
+
+
+      // Store integer variables
+      else
+      {
+         isInt.resize(variable.size());
+
+         for( auto it = isInt.begin(); it != isInt.end(); ++it )
+         {
+            *it = false;
+         }
+
+         if( numberOfIntegers > 0 ) {
+
+            for( int i = 0; i < numberOfIntegers; ++i )
+            {
+               int index;
+
+               certificateFile >> index;
+               if( certificateFile.fail() )
+               {
+                  err << "Error reading integer index " << i << endl;
+            goto TERMINATE;
+               }
+               isInt[index] = true;
+            }
+         }
+         returnStatement = true;
+      }
+   }
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+// Processes the sense of the objective function and coefficients for variables
+// Stores sense and runs subroutine to store coefficients
+// Error if objective sense invalid (other than -1, 0, 1 for min, equality, max) or subroutine fails
+bool Certificate::processOBJ()
+{
+   out << endl << "Processing OBJ section..." << endl;
+   stats.startPhase("OBJ");
+
+   bool returnStatement = false;
+
+   string section;
+
+   certificateFile >> section;
+
+
+   // Check section
+   if( section != "OBJ" )
+   {
+      err << "OBJ expected.   Read instead " << section << endl;
+   }
+   else
+   {
+      string objectiveSense;
+
+      certificateFile >> objectiveSense;
+
+      if( objectiveSense == "min" )
+      {
+          isMin = true;
+      }
+      else if( objectiveSense == "max" )
+      {
+          isMin = false;
+      }
+      else
+      {
+          err << "Invalid objective sense: " << objectiveSense << endl;
+          goto TERMINATE;
+      }
+
+      returnStatement = readConstraintCoefficients(objectiveCoefficients);
+      objectiveIntegral = true;
+
+      for( auto it = objectiveCoefficients->begin(); it != objectiveCoefficients->end(); ++it )
+      {
+         if ( !isInteger(it->second) || !isInt[it->first] )
+            objectiveIntegral = false;
+      }
+
+      if( !returnStatement )
+      {
+         err << "Failed to read objective coefficients" << endl;
+      }
+   }
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+// Processes constraints
+// Produces vector of constraints and calls subroutine
+// Error if number of constraints or bounds smaller 0
+bool Certificate::processCON()
+{
+   out << endl << "Processing CON section..." << endl;
+   stats.startPhase("CON");
+
+   bool returnStatement = false;
+
+   string section;
+
+   certificateFile >> section;
+
+
+   // Check section
+   if( section != "CON" )
+   {
+      err << "CON expected.   Read instead " << section << endl;
+   }
+   else
+   {
+      certificateFile >> numberOfConstraints >> numberOfBounds;
+      // numberOfBounds not used in verification but useful for debugging
+
+      if( certificateFile.fail() || numberOfConstraints < 0 || numberOfBounds < 0 )
+      {
+         err << "Invalid number(s) after CON" << endl;
+      }
+
+
+      // Store constraints
+      else
+      {
+         string label;
+         int sense;
+         mpq_class rhs;
+
+         for( int i = 0; i < numberOfConstraints; i++ )
+         {
+            shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
+
+            returnStatement = readConstraint(label, sense, rhs, coef);
+
+            if( !returnStatement ) break;
+
+            constraint.push_back(Constraint(label, sense, rhs, coef, false, emptyList));
+         }
+      }
+   }
+
+   return returnStatement;
+}
+
+
+// Processes the relation to prove - either infeasibility or given range
+// Stores type of relation
+// Error if invalid verification type or bounds
+bool Certificate::processRTP()
+{
+
+   out << endl << "Processing RTP section..." << endl;
+   stats.startPhase("RTP");
+
+   bool returnStatement = false;
+
+   string section;
+
+   certificateFile >> section;
+
+   // Checking section
+   if( section != "RTP" )
+   {
+      err << "RTP expected.   Read instead " << section << endl;
+   }
+   else
+   {
+      string relationToProveTypeStr;
+
+      certificateFile >> relationToProveTypeStr;
+
+
+      // Check verification type
+      if( relationToProveTypeStr == "infeas" )
+      {
+         relationToProveType = RelationToProveType::INFEAS;
+
+         out << endl << "Need to verify infeasibility. " << endl;
+      }
+      else if( relationToProveTypeStr != "range" )
+      {
+         err << "RTP: unrecognized verification type: " << relationToProveTypeStr << endl;
+         goto TERMINATE;
+      }
+      else
+      {
+         relationToProveType = RelationToProveType::RANGE;
+
+         checkLower = checkUpper = false;
+
+         certificateFile >> lowerStr >> upperStr;
+
+         if( lowerStr != "-inf" )
+         {
+            checkLower = true;
+            lowerBound = mpq_class(lowerStr);
+         }
+
+         if( upperStr != "inf" )
+         {
+            checkUpper = true;
+            upperBound = mpq_class(upperStr);
+         }
+
+
+         // Check bounds
+         if( checkLower && checkUpper && (lowerBound > upperBound) )
+         {
+            err << "RTP: invalid bounds. " << endl;
+            goto TERMINATE;
+         }
+
+
+         // Stores relation as Constraint variable
+         if( isMin && checkLower )
+         {
+            relationToProve = Constraint("rtp", 1, lowerBound, objectiveCoefficients, false, emptyList);
+         }
+         else if( !isMin && checkUpper )
+         {
+            relationToProve = Constraint("rtp", -1, upperBound, objectiveCoefficients, false, emptyList);
+         }
+         else
+         {
+            returnStatement = true;
+            goto TERMINATE;
+         }
+
+         out << "Need to verify optimal value range "
+                << (lowerStr == "-inf" ? "(" : "[")
+                << lowerStr << ", " << upperStr
+                << (upperStr == "inf" ? ")" : "]")
+                << "." << endl;
+
+      }
+      returnStatement = true;
+   }
+
+TERMINATE:
+   return returnStatement;
+
+}
+
+
+// Rounding
+static mpq_class floor(const mpq_class &q)
+{
+   if( isInteger(q) )
+      return q;
+
+   mpz_t z;
+   mpq_class result;
+   mpz_init (z);
+   mpz_fdiv_q(z, q.get_num_mpz_t(), q.get_den_mpz_t()); // Divide numerator by denominator and floor the result
+   result = mpz_class(z);
+   mpz_clear (z);
+   return result;
+}
+
+
+static mpq_class ceil(const mpq_class &q)
+{
+   if( isInteger(q) )
+      return q;
+
+   mpz_t z;
+   mpq_class result;
+   mpz_init (z);
+   mpz_cdiv_q(z, q.get_num_mpz_t(), q.get_den_mpz_t()); // Divide numerator by denominator and ceil the result
+   result = mpz_class(z);
+   mpz_clear (z);
+   return result;
+}
+
+// mpq_class is always canonical, so q is integral iff its denominator is one
+bool isInteger(const mpq_class &q)
+{
+   return mpz_cmp_ui(q.get_den_mpz_t(), 1) == 0;
+}
+
+
+bool Certificate::readMultipliers(int &sense, SVectorGMP &mult)
+{
+
+   int k;
+   bool returnStatement = true;
+
+   sense = 0;
+   mult.clear();
+
+   certificateFile >> k;
+
+   for( auto j = 0; j < k; ++j )
+   {
+      mpq_class a;
+      int index;
+
+      certificateFile >> index >> a;
+
+      if( index < 0 || index >= (int) constraint.size() )
+      {
+         err << "Multiplier index out of bounds: " << index << endl;
+         returnStatement = false;
+         goto TERMINATE;
+      }
+
+      if( a == 0 ) continue; // ignore 0 multiplier
+
+      mult.push_back(index, a);
+      ++numberOfMultipliers;
+
+#ifndef NDEBUG
+      // only the label, the constraint may be trashed meanwhile by the parallel checker
+      out << "multiplying " << a << " * " << constraint[index].label() << std::endl;
+#endif
+
+      if( sense == 0 )
+      {
+         sense = constraint[index].getSense() * sgn(a);
+      }
+      else
+      {
+         int tmp = constraint[index].getSense() * sgn(a);
+         if( tmp != 0 && sense != tmp )
+         {
+            err << "Coefficient has wrong sign for index " << index << endl;
+            returnStatement = false;
+            goto TERMINATE;
+         }
+      }
+   }
+
+   mult.compactify();
+
+TERMINATE:
+   return returnStatement;
+}
+
+// Read and store constraints
+bool Certificate::readConstraintCoefficients(shared_ptr<SVectorGMP> &coefficients)
+{
+   auto returnStatement = false;
+   int k = 0;
+   string tmp;
+
+   coefficients->clear();
+   certificateFile >> tmp;
+
+   if( tmp == "OBJ" ) // case that constraint = objective function
+   {
+      coefficients = objectiveCoefficients;
+      returnStatement = true;
+   }
+   else
+   {
+      k = atoi(tmp.c_str());
+
+      if( certificateFile.fail() )
+      {
+         err << "Error reading number of elements " << endl;
+         goto TERMINATE;
+      }
+      else
+      {
+         coefficients->reserve(k);
+         for( int j = 0; j < k; j++ )
+         {
+            int index;
+            mpq_class a;
+
+            certificateFile >> index >> a;
+            if( certificateFile.fail() )
+            {
+               err << "Error reading integer-rational pair " << endl;
+               goto TERMINATE;
+            }
+            else if( index < 0 || index >= numberOfVariables )
+            {
+               err << "Index out of bounds: " << index << endl;
+               goto TERMINATE;
+            }
+            coefficients->push_back(index, std::move(a));
+         }
+         returnStatement = true;
+      }
+   }
+
+   coefficients->compactify();
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+bool Certificate::readConstraint(string &label, int &sense, mpq_class &rhs, shared_ptr<SVectorGMP> &coefficients)
+{
+
+   auto returnStatement = false;
+   char senseChar = 0;
+
+   certificateFile >> label >> senseChar;
+
+   if( !certificateFile.fail() )
+   {
+      if( senseChar == 'E' )
+         sense = 0;
+      else if( senseChar == 'L' )
+         sense = -1;
+      else if( senseChar == 'G' )
+         sense = 1;
+      else
+      {
+        err << "Unknown sense for " << label << ": " << senseChar << endl;
+        goto TERMINATE;
+      }
+
+      certificateFile >> rhs;
+
+      if( !certificateFile.fail() )
+         returnStatement = readConstraintCoefficients(coefficients);
+
+      if( !returnStatement ) err << label <<   ": Error reading constraint " << endl;
+   }
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+// con1 and con2 must be inequalities for an integer disjunction
+// e.g. mx <= d and mx >= d+1 such that the variables indexed by
+// the support of m are integers.   The function checks this.
+// a1 and a2 are assumptions.
+bool Certificate::canUnsplit(  const Constraint &toDer, const int toDerIdx, const int con1, const int a1,
+                              const int con2, const int a2) const
+{
+
+   bool returnStatement = false;
+
+   if( (con1 < 0) || (con1 >= toDerIdx) )
+   {
+      err << "con1 out of bounds: " << con1 << endl;
+      return false;
+   }
+
+   if( (con2 < 0) || (con2 >= toDerIdx) )
+   {
+      err << "con2 out of bounds: " << con2 << endl;
+      return false;
+   }
+
+   if( (a1 < 0) || (a1 >= toDerIdx) )
+   {
+      err << "asm1 out of bounds: " << a1 << endl;
+      return false;
+   }
+
+   if( (a2 < 0) || (a2 >= toDerIdx) )
+   {
+      err << "asm2 out of bounds: " << a2 << endl;
+      return false;
+   }
+
+   const Constraint &c1 = constraint[con1];
+   const Constraint &c2 = constraint[con2];
+
+   const Constraint &branchAsm1 = constraint[a1];
+   const Constraint &branchAsm2 = constraint[a2];
+
+   if( c1.isTrashed() )
+   {
+      err << "unsplitting trashed constraint: " << c1.label() << endl;
+      goto TERMINATE;
+   }
+   else if( c2.isTrashed() )
+   {
+      err << "unsplitting trashed constraint: " << c2.label() << endl;
+      goto TERMINATE;
+   }
+
+   if( c1.dominates(toDer) && c2.dominates(toDer) )
+   {
+      if( branchAsm1.isTrashed() )
+      {
+         err << "accessing trashed constraint: " << branchAsm1.label() << endl;
+         goto TERMINATE;
+      }
+      else if( branchAsm2.isTrashed() )
+      {
+         err << "accessing trashed constraint: " << branchAsm2.label() << endl;
+         goto TERMINATE;
+      }
+
+
+      // the constraints must have opposite senses
+      if( -1 != branchAsm1.getSense() * branchAsm2.getSense() )
+      {
+         err << "canUnsplit: Failed sense requirement for assumptions" << endl;
+         err << "branchAsm1 sense:: " << branchAsm1.getSense() << endl;
+         err << "branchAsm2 sense:: " << branchAsm2.getSense() << endl;
+         goto TERMINATE;
+      }
+      else
+      {
+
+         // check if disjunction gives a tautology with respect to the variable
+         // integrality requirements
+         bool stat = true;
+         if( branchAsm1.getSense() < 0 )
+            stat = ((branchAsm1.getRhs() + 1) == branchAsm2.getRhs());
+         else // must be > 0
+            stat = (branchAsm1.getRhs() == (branchAsm2.getRhs() + 1));
+
+         if( !stat ) {
+            err << branchAsm1.label() << " and " << branchAsm2.label()
+                << " do not form a tautology" << endl;
+            goto TERMINATE;
+         };
+
+         shared_ptr<SVectorGMP> c1ptr = branchAsm1.coefSVec();
+         shared_ptr<SVectorGMP> c2ptr = branchAsm2.coefSVec();
+         if( (c1ptr == c2ptr) || (*c1ptr == *c2ptr) ) // coefSVec can both point to objectiveCoefficients
+         {
+
+            for( auto it = c1ptr->begin(); it != c1ptr->end(); ++it )
+            {
+               if( !isInt[it->first] )
+               {
+                  err << "canUnsplit: noninteger variable index " << it->first
+                         << endl;
+                  goto TERMINATE;
+               }
+               else if( !isInteger(it->second) )
+               {
+                  err << "canUnsplit: noninteger coefficient for index "
+                         << it->first << endl;
+                  goto TERMINATE;
+               }
+            }
+         }
+         else
+         {
+            err << "canUnsplit: coefs of asm constraints differ" << endl;
+            goto TERMINATE;
+         }
+         returnStatement = true;
+      }
+   }
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+// Both tools read the multipliers first and check the combination later, viprchk_parallel in
+// parallel to the reading of the next derivations
+bool Certificate::checkLinComb(  const Constraint &toDer, const DerivationType derivationType, const int sense,
+                                 const SVectorGMP &mult, DenseAccumulator &acc, ArithmeticCounts &counts)
+{
+   bool returnStatement = true;
+
+   shared_ptr<SVectorGMP> coefficients;
+   mpq_class rhs;
+   HybridRational rhsAcc;
+
+   acc.resize(numberOfVariables);
+
+   for( auto it = mult.begin(); it != mult.end(); ++it )
+   {
+      auto index = it->first;
+      auto a = it->second;
+
+      const Constraint &con = constraint[index];
+
+      if( con.isTrashed() )
+      {
+         err << "Accessing trashed constraint: " << con.label() << endl;
+         returnStatement = false;
+      }
+      else
+      {
+         shared_ptr<SVectorGMP> c = con.coefSVec();
+
+         for( auto itr = c->begin(); itr != c->end(); ++itr )
+            acc.addProduct(itr->first, a, itr->second, counts);
+
+         rhsAcc.addProduct(a, con.getRhs(), counts);
+      }
+   }
+
+   // most derived coefficients are exactly the stated ones, which are then shared instead of copied
+   if( acc.matches(*toDer.coefSVec()) )
+      coefficients = toDer.coefSVec();
+   else
+   {
+      coefficients = make_shared<SVectorGMP>();
+      acc.gather(*coefficients);
+      coefficients->compactify();
+   }
+   rhsAcc.get(rhs);
+
+   if( !returnStatement )
+      return false;
+
+   Constraint derived("", sense, rhs, coefficients, false, emptyList);
+
+   if( derivationType == DerivationType::RND )   // round the coefficients
+      if( !derived.round(isInt, err) )
+         return false;
+
+   // check the from reason derived constraint against the given
+   if( !derived.dominates(toDer) )
+   {
+      out << "Failed to derive constraint " << toDer.label() << endl;
+      toDer.print(out, variable);
+
+      out << "Derived instead " << endl;
+      derived.print(out, variable);
+
+      out << "difference: " << endl;
+      (derived - toDer).print(out, variable);
+
+      return false;
+   }
+
+   return true;
+}
+
+
+// AssumptionSet methods
+void AssumptionSet::merge(const AssumptionSet &other)
+{
+   if( other._indices == _indices || other.empty() || std::includes(begin(), end(), other.begin(), other.end()) )
+      return;
+
+   if( empty() || std::includes(other.begin(), other.end(), begin(), end()) )
+   {
+      _indices = other._indices;
+      return;
+   }
+
+   auto indices = make_shared<vector<int>>();
+   indices->reserve(size() + other.size());
+   std::set_union(begin(), end(), other.begin(), other.end(), std::back_inserter(*indices));
+   _indices = indices;
+}
+
+
+AssumptionSet AssumptionSet::without(const int index) const
+{
+   if( !contains(index) )
+      return *this;
+
+   AssumptionSet result;
+
+   if( size() > 1 )
+   {
+      auto indices = make_shared<vector<int>>();
+      indices->reserve(size() - 1);
+      std::remove_copy(begin(), end(), std::back_inserter(*indices), index);
+      result._indices = indices;
+   }
+
+   return result;
+}
+
+
+// Constraint methods
+bool Constraint::round(const vector<bool> &isInt, std::ostream &err)
+{
+   bool returnStatement = true;
+
+   for( auto it = _coefficients->begin(); it != _coefficients->end(); ++it )
+   {
+      auto j = it->first;
+      const mpq_class &a = it->second;
+
+      if( isInt[j] )
+      {   // needs to be an integer variable
+         if( !isInteger(a) )
+         {
+            err << "Coefficient of integer variable with index "
+                 << j << " is not an integer" << endl;
+            returnStatement = false;
+            goto TERMINATE;
+         }
+      }
+   }
+
+   if( getSense() < 0 ) // round down
+      _rhs = floor(_rhs);
+   else if( getSense() > 0 ) // round up
+      _rhs = ceil(_rhs);
+
+TERMINATE:
+   return returnStatement;
+}
+
+
+bool Constraint::_isFalsehood()
+{
+   bool returnStatement = false;
+
+   if( _coefficients->size() == 0 )
+   {
+      if( ((getSense() <= 0) && (_rhs < 0)) || ((getSense() >= 0) && (_rhs > 0)) )
+         returnStatement = true;
+   }
+
+   return returnStatement;
+}
+
+
+bool Constraint::dominates(const Constraint &other) const
+{
+   bool returnStatement = false;
+
+   if( this->isFalsehood() )
+   {
+      returnStatement = true;
+   }
+   else if( this->_coefficients == other._coefficients
+         || *(this->_coefficients) == *(other._coefficients) )  // force object comparison
+   {
+      if( (other.getSense() > 0 && this->getSense() >= 0 &&
+             this->_rhs >= other._rhs)
+         || (other.getSense() < 0 && this->getSense() <= 0 &&
+             this->_rhs <= other._rhs)
+         || (other.getSense() == 0 && this->getSense() == 0 &&
+             this->_rhs == other._rhs) )
+      {
+         returnStatement = true;
+      }
+   }
+
+   return returnStatement;
+}
+
+
+bool Constraint::isTautology() {
+   bool returnStatement = false;
+
+   if( _coefficients->size() == 0 )
+   {
+      if( ((getSense() == 0) && (0 == _rhs))
+         || ((getSense() < 0) && (_rhs >= 0))
+         || ((getSense() > 0) && (_rhs <= 0)) )
+      {
+         returnStatement = true;
+      }
+   }
+   return returnStatement;
+}
+
+
+void Constraint::print(std::ostream &out, const vector<string> &variable) const
+{
+   bool first = true;
+   mpq_class myCoefficient;
+   out.precision(std::numeric_limits<double>::max_digits10);
+
+   int count = 0;
+
+   if( _isAssumption )
+      out << "Is assumption: ";
+
+   for( auto it = _coefficients->begin(); it != _coefficients->end(); ++it )
+   {
+      auto index = it->first;
+      auto a = it->second;
+
+      myCoefficient = abs(a);
+
+      if( a > 0 )
+      {
+         if( !first ) out << " + ";
+         out << (myCoefficient == 1 ? string("") : string(myCoefficient.get_str()) + " ")
+              << "( " << a.get_d() << " ) "
+              << variable[index];
+         ++count;
+         first = false;
+      }
+      else if( a < 0 )
+      {
+         out << " - "
+                << (myCoefficient == 1 ? string("") : string(myCoefficient.get_str()) + " ")
+                << "( " << a.get_d() << " ) "
+                << variable[index];
+         first = false;
+         ++count;
+      }
+
+      if( (count+1) % 4 == 0 ) out << endl;
+   }
+
+   if( first ) // coefficients are all zero
+   {
+      out << "0";
+   }
+
+   switch( _sense )
+   {
+      case -1: out << " <= "; break;
+      case 1: out << " >= "; break;
+      case 0: out << " = "; break;
+      default : assert(false);
+   }
+   out << _rhs << " ( " << _rhs.get_d() << " )" << endl;
+
+#ifdef MORE_DEBUG_OUTPUT
+   if( !_isAssumption )
+   {
+      out << " -- assumptions: " << endl;
+      for( auto index : _assumptionList )
+         out << "   "<< index << endl;
+      out << endl;
+   }
+#endif
+}
+
+} // namespace vipr
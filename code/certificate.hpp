@@ -0,0 +1,267 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Constraints of a certificate and the reading of its sections
+//
+// Shared by viprchk (libvipr) and viprchk_parallel: Certificate reads everything up to
+// the SOL section and holds the model, the relation to prove and all constraints. The
+// DER section is read derivation by derivation with the readers below, and the linear
+// combinations and unsplits are checked here; the tools only differ in the order and
+// the threads in which they do so, and they check the SOL section themselves.
+
+#ifndef _VIPR_CERTIFICATE_HPP_
+#define _VIPR_CERTIFICATE_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+#include <tbb/concurrent_vector.h>
+#include "stats.hpp"
+#include "svector.hpp"
+#include "tokenizer.hpp"
+
+namespace vipr
+{
+
+// Types
+// Set of assumption indices; the sorted indices are shared between copies and never modified, so
+// that constraints derived from the same assumptions store them only once
+class AssumptionSet
+{
+   public:
+      AssumptionSet() {}
+      explicit AssumptionSet(const int index) : _indices(std::make_shared<const std::vector<int>>(1, index)) {}
+      // takes over indices that are already sorted
+      explicit AssumptionSet(std::vector<int> &&indices)
+         : _indices(indices.empty() ? nullptr : std::make_shared<const std::vector<int>>(std::move(indices))) {}
+
+      bool empty() const { return size() == 0; }
+      size_t size() const { return _indices ? _indices->size() : 0; }
+      const int* begin() const { return _indices ? _indices->data() : nullptr; }
+      const int* end() const { return begin() + size(); }
+
+      bool contains(const int index) const { return std::binary_search(begin(), end(), index); }
+
+      // adds the indices of other; shares the indices of an operand that contains the other one
+      void merge(const AssumptionSet &other);
+
+      // copy without the given index
+      AssumptionSet without(const int index) const;
+
+      bool operator==(const AssumptionSet &other) const
+      {
+         return _indices == other._indices || std::equal(begin(), end(), other.begin(), other.end());
+      }
+      bool operator!=(const AssumptionSet &other) const { return !(*this == other); }
+
+      void clear() { _indices = nullptr; }
+
+   private:
+      std::shared_ptr<const std::vector<int>> _indices;
+};
+
+// The type of derivation used to derive a constraint
+enum DerivationType
+{
+   ASM,   // assumption
+   LIN,   // simple implication
+   RND,   // simple implication with integer rounding; i.e. a CG cut
+   UNS,   // unsplit operation
+   SOL,   // cutoff bound from primal solution
+   UNKNOWN
+};
+
+// The type of relation to prove
+enum RelationToProveType
+{
+   INFEAS,   // infeasible
+   RANGE   // lower bound (-inf if none) and upper bound (inf if none) to be verified
+};
+
+
+// Classes
+// Constraint format
+class Constraint
+{
+   public:
+      Constraint() {}
+
+      Constraint( const std::string label, const int sense, const mpq_class rhs,
+                  std::shared_ptr<SVectorGMP> coefficients, const bool isAssumptionCon,
+                  const AssumptionSet assumptionList):
+
+                  _label(label), _sense(sense), _rhs(rhs), _coefficients(coefficients),
+                  _isAssumption(isAssumptionCon), _assumptionList(assumptionList)
+                  {
+                     _coefficients->compactify();
+                     _trashed = false;
+                     _falsehood = _isFalsehood();
+                  }
+
+      bool round(const std::vector<bool> &isInt, std::ostream &err);
+
+      mpq_class getRhs() const { return _rhs; }
+      mpq_class getCoef(const int index) { return _coefficients->get(index); }
+
+      std::shared_ptr<SVectorGMP> coefSVec() const { return _coefficients; }
+
+      int getSense() const { return _sense; }
+
+      bool isAssumption() const { return _isAssumption; }
+
+      bool isFalsehood() const { return _falsehood; }
+                  // true iff the constraint is a contradiction like 0 >= 1
+
+      bool isTautology();
+                  // true iff the constraint is a tautology like 0 <= 1
+
+      bool hasAsm(const int index) const { return _assumptionList.contains(index); }
+
+      void setassumptionList(const AssumptionSet &assumptionList) { _assumptionList = assumptionList; }
+      const AssumptionSet &getassumptionList() const { return _assumptionList; }
+
+      bool dominates(const Constraint &other) const;
+      void print(std::ostream &out, const std::vector<std::string> &variable) const;
+
+      void trash() { _trashed = true; _falsehood = false; _coefficients = nullptr;
+                     _rhs = 0; _assumptionList.clear(); }
+      bool isTrashed() const { return _trashed; }
+
+      std::string label() const { return _label; }
+
+      void setMaxRefIdx(int refIdx) { _refIdx = refIdx; }
+      int getMaxRefIdx() const { return _refIdx; }
+
+      Constraint operator-(const Constraint& other)
+      {
+         Constraint returncons(*this);
+         returncons._coefficients = std::make_shared<SVectorGMP>(*_coefficients - *other._coefficients);
+
+         returncons._rhs -= other._rhs;
+         return returncons;
+      }
+
+   private:
+      std::string _label;
+      int _sense;
+      mpq_class _rhs;
+      std::shared_ptr<SVectorGMP> _coefficients;
+      int _refIdx = -1;
+      bool _isAssumption;
+      AssumptionSet _assumptionList; // constraint index list that are assumptions
+      bool _falsehood;
+
+      bool _isFalsehood();
+      bool _trashed;
+};
+
+extern const AssumptionSet emptyList;
+
+// all constraints of a certificate, including derived ones; the constraints stay in place
+// while new ones are appended, so that derivations can be checked while the next ones are read
+typedef tbb::concurrent_vector<Constraint> ConstraintList;
+
+bool isInteger(const mpq_class &q); // check if variable is integer
+
+// Model, relation to prove and constraints of one certificate
+class Certificate
+{
+   public:
+      // progress and results are written to out, errors to err
+      Certificate(std::ostream &out, std::ostream &err, Stats &stats) : out(out), err(err), stats(stats)
+      {
+         certificateFile.setErrorStream(err);
+      }
+
+      Tokenizer certificateFile; // certificate file tokenizer
+
+   protected:
+      std::ostream &out; // progress and results
+      std::ostream &err; // errors
+      Stats &stats; // phase times and counters of this check
+
+      int numberOfVariables = 0; // number of variables
+      int numberOfConstraints = 0; // number of constraints
+      int numberOfBounds = 0; // number of bounds
+      int numberOfDerivations = 0; // number od derivations
+      int numberOfSolutions = 0; // number of solutions
+      std::vector<bool> isInt; // integer variable indices
+      std::vector<std::string> variable; // variable names
+      ConstraintList constraint; // all the constraints, including derived ones
+
+      RelationToProveType relationToProveType = INFEAS;
+      mpq_class bestObjectiveValue; // best objective function value of specified solutions
+      mpq_class lowerBound; // lower bound for optimal value to be checked
+      mpq_class upperBound; // upper bound for optimal value to be checked
+      std::string lowerStr, upperStr;
+      bool isMin = false; // is minimization problem
+      bool checkLower = false; // true iff need to verify lower bound
+      bool checkUpper = false; // true iff need to verify upper bound
+      Constraint relationToProve; // constraint to be derived in the case of bound checking
+      std::shared_ptr<SVectorGMP> objectiveCoefficients = std::make_shared<SVectorGMP>(); // obj coefficients
+      bool objectiveIntegral = false;
+      long long derivationsOfType[UNKNOWN + 1] = {}; // number of derivations by DerivationType
+      long long numberOfNonzeros = 0; // nonzeros of the derived constraints
+      long long numberOfMultipliers = 0; // nonzero multipliers of lin and rnd derivations
+
+      // sections before SOL, in order of appearance
+      bool checkVersion(std::string ver);
+      bool processVER();
+      bool processVAR();
+      bool processINT();
+      bool processOBJ();
+      bool processCON();
+      bool processRTP();
+
+      bool readMultipliers(int &sense, SVectorGMP &mult);
+      bool readConstraintCoefficients(std::shared_ptr<SVectorGMP> &v);
+      bool readConstraint( std::string &label, int &sense, mpq_class &rhs,
+                           std::shared_ptr<SVectorGMP> &coef);
+
+      // checks that the combination mult of constraints, rounded for RND, dominates toDer; acc and
+      // counts belong to the calling thread, the combined constraints must not be trashed meanwhile
+      bool checkLinComb(  const Constraint &toDer, const DerivationType derivationType, const int sense,
+                          const SVectorGMP &mult, DenseAccumulator &acc, ArithmeticCounts &counts);
+
+      // whether the derivation with index toDerIdx must not refer to constraint index anymore, since its
+      // index of last reference is smaller; verifiers may discard the constraint after that derivation
+      bool isReleased(const int index, const int toDerIdx) const
+      {
+         int maxRefIdx = constraint[index].getMaxRefIdx();
+         return maxRefIdx >= 0 && maxRefIdx < toDerIdx;
+      }
+
+      // checks that unsplitting con1 and con2 on the assumptions a1 and a2 derives toDer, which has
+      // index toDerIdx; all four have to precede toDer
+      bool canUnsplit(  const Constraint &toDer, const int toDerIdx, const int con1, const int a1,
+                        const int con2, const int a2) const;
+};
+
+} // namespace vipr
+
+#endif
@@ -0,0 +1,69 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+
+// Allocator of the limbs of GMP numbers in the parallel tools
+//
+// Every thread creates and destroys many exact rationals while checking, so GMP's
+// allocation functions are pointed directly to the scalable allocator of TBB instead
+// of going through malloc. GMP numbers may already exist when main starts, e.g. as
+// globals, and are later freed through these functions; this is only safe if malloc
+// itself is served by tbbmalloc, so the functions are installed only together with
+// tbbmalloc_proxy (VIPR_WITH_TBBMALLOC).
+
+#ifndef _VIPR_GMPALLOC_HPP_
+#define _VIPR_GMPALLOC_HPP_
+
+#include <cstddef>
+#include <gmp.h>
+#include "CMakeConfig.hpp"
+
+#ifdef VIPR_WITH_TBBMALLOC
+#include <tbb/scalable_allocator.h>
+
+inline void* gmpScalableAlloc(size_t size)
+{
+   return scalable_malloc(size);
+}
+
+inline void* gmpScalableRealloc(void* ptr, size_t, size_t newSize)
+{
+   return scalable_realloc(ptr, newSize);
+}
+
+inline void gmpScalableFree(void* ptr, size_t)
+{
+   scalable_free(ptr);
+}
+#endif
+
+// lets GMP allocate from tbbmalloc if the tools are built with it, call first in main
+inline void useScalableAllocatorForGMP()
+{
+#ifdef VIPR_WITH_TBBMALLOC
+   mp_set_memory_functions(gmpScalableAlloc, gmpScalableRealloc, gmpScalableFree);
+#endif
+}
+
+#endif
@@ -22,23 +22,37 @@
  *
  */
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <random>
+#include <atomic>
+#include <thread>
 #include "soplex.h"
 #include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+
+// Timing
+#include <sys/time.h>
+
+// TBB
+#include <tbb/tbb.h>
 
 using namespace std;
 using namespace soplex;
 
-ifstream certificateFile;
+Tokenizer certificateFile;
 ofstream incompleteFile;
+vector<char> incompleteBuffer(1 << 22);
 std::string incomptype = "incomplete";
 std::string incompobj = "all";
 
 long numberOfConstraints = 0;
 double percentageIncomplete = 100;
+unsigned long long seed = 0; // the same seed selects the same derivations, independent of the number of threads
+unsigned int nthreads = std::thread::hardware_concurrency();
 
+// The section readers copy every entry to the incomplete file while reading it and keep no constraints,
+// so they are not those of vipr::Certificate, which stores all of them for checking
 void modifyFileName(string &path, const string &newExtension);
 bool checkversion(string ver);
 bool processVER();
@@ -50,39 +64,67 @@ bool processRTP();
 bool processSOL();
 bool processDER();
 
+static double getTimeSecs(timeval start, timeval end)
+{
+   return (end.tv_sec + end.tv_usec / 1000000.0) - (start.tv_sec + start.tv_usec / 1000000.0);
+}
+
 int main(int argc, char *argv[])
 {
    int returnStatement = -1;
    std::string modifyName;
+   vector<const char*> arguments;
+   timeval start, end;
+
+   std::cout << "Usage [--seed=<number>] [--threads=<number>] <filename> <percentage> (0-100) <type> (incomplete/weak) <all?> (all/noobj)" << endl;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (strncmp(argv[i], "--seed=", 7) == 0 && isdigit(argv[i][7]))
+         seed = strtoull(&argv[i][7], nullptr, 10);
+      else if (strncmp(argv[i], "--threads=", 10) == 0 && atoi(&argv[i][10]) > 0)
+         nthreads = atoi(&argv[i][10]);
+      else if (argv[i][0] == '-' && argv[i][1] == '-')
+      {
+         cerr << "invalid option \"" << argv[i] << "\"" << endl;
+         return returnStatement;
+      }
+      else
+         arguments.push_back(argv[i]);
+   }
 
-   std::cout << "Usage <filename> <percentage> (0-100) <type> (incomplete/weak) <all?> (all/noobj)" << endl;
+   if (arguments.empty())
+   {
+      cerr << "missing input file" << endl;
+      return returnStatement;
+   }
 
-   certificateFile.open(argv[1]);
+   certificateFile.open(arguments[0]);
 
    if (certificateFile.fail())
    {
-      cerr << "Failed to open file " << argv[1] << endl;
+      cerr << "Failed to open file " << arguments[0] << endl;
       return returnStatement;
    }
 
-   if(argc > 2)
+   if(arguments.size() > 1)
    {
-      percentageIncomplete = atof(argv[2]);
-      modifyName = argv[2];
+      percentageIncomplete = atof(arguments[1]);
+      modifyName = arguments[1];
    }
 
-   if(argc > 3)
+   if(arguments.size() > 2)
    {
-      incomptype = argv[3];
+      incomptype = arguments[2];
    }
 
-   if(argc > 4)
+   if(arguments.size() > 3)
    {
-      incompobj = argv[4];
+      incompobj = arguments[3];
    }
 
 
-   string path = argv[1];
+   string path = arguments[0];
    modifyName.append("_");
    modifyName.append(incomptype);
    modifyName.append("_");
@@ -90,6 +132,7 @@ int main(int argc, char *argv[])
    modifyName.append(".vipr");
    modifyFileName(path, modifyName);
 
+   incompleteFile.rdbuf()->pubsetbuf(incompleteBuffer.data(), incompleteBuffer.size());
    incompleteFile.open(path.c_str(), std::ios::out);
 
    if (incompleteFile.fail())
@@ -98,6 +141,7 @@ int main(int argc, char *argv[])
       return returnStatement;
    }
 
+   gettimeofday(&start, 0);
    double start_cpu_tm = clock();
    if (processVER())
       if (processVAR())
@@ -112,11 +156,20 @@ int main(int argc, char *argv[])
 
                            returnStatement = 0;
                            double cpu_dur = (clock() - start_cpu_tm) / (double)CLOCKS_PER_SEC;
+                           gettimeofday(&end, 0);
 
                            cout << endl
                                 << "Completed in " << cpu_dur
-                                << " seconds (CPU)" << endl;
+                                << " seconds (CPU), " << getTimeSecs(start, end) << " seconds (Wall Clock)" << endl;
                         }
+
+   incompleteFile.close();
+   if (returnStatement == 0 && incompleteFile.fail())
+   {
+      cerr << "Failed to write file " << path << endl;
+      returnStatement = -1;
+   }
+
    return returnStatement;
 }
 
@@ -442,216 +495,304 @@ bool processSOL()
    return returnStatement;
 }
 
-bool processDER()
+// reads the space separated tokens of a derivation that is held in memory
+class TokenCursor
 {
-   // random number generation
-   std::random_device rd;  // a seed source for the random number engine
-   std::mt19937 gen(rd()); // mersenne_twister_engine seeded with rd()
-   std::uniform_int_distribution<> distrib(0, 100);
+ public:
+   TokenCursor( const string &text ) : _cur( text.c_str() ), _end( text.c_str() + text.size() ) {}
 
-   bool returnStatement = false;
-   string section, numberOfCoefficients, label, consense, bracket, kind;
-   int intOfCoefficients = 0;
-   long idx, sense, numberOfDerivations;
-   long derHir;
-   string val, rhs;
-   bool incomplete = (incomptype == "incomplete");
-   bool incompleteObj = (incompobj == "all");
+   bool next( string &token )
+   {
+      while( _cur < _end && *_cur == ' ' ) ++_cur;
 
-   std::cout << endl
-        << "Processing DER section... " << endl;
-   certificateFile >> section;
+      const char* start = _cur;
+      while( _cur < _end && *_cur != ' ' ) ++_cur;
 
-   if (section != "DER")
-   {
-      cerr << "DER expected.   Read instead " << section << endl;
-      return false;
+      token.assign( start, _cur - start );
+      if( token.empty() ) _fail = true;
+      return !_fail;
    }
 
-   incompleteFile << "\r\n" + section;
+   bool fail() const { return _fail; }
 
-   certificateFile >> numberOfDerivations;
-   incompleteFile << " " + to_string(numberOfDerivations);
+ private:
+   const char* _cur;
+   const char* _end;
+   bool _fail = false;
+};
 
-   if (numberOfDerivations == 0)
+// reads one derivation from the file; its tokens are stored separated by single spaces
+// the derivation ends with the index after the closing brace of its reason
+static bool readDerivation( Tokenizer &pf, string &text )
+{
+   TokenView token;
+   int depth = 0;
+   bool inReason = false;
+
+   text.clear();
+
+   while( pf.nextToken( token ) )
    {
-      cout << "Number of derivations = 0. Nothing to complete." << endl;
-      return true;
+      if( !text.empty() ) text += ' ';
+      text.append( token.data, token.size );
+
+      if( inReason && depth == 0 ) return true;
+
+      if( token == "{" )
+      {
+         ++depth;
+         inReason = true;
+      }
+      else if( token == "}" )
+         --depth;
    }
 
-   for (int i = 0; i < numberOfDerivations; ++i)
-   {
+   return false;
+}
 
-      certificateFile >> label >> consense >> rhs;
-      incompleteFile << "\r\n"
-                     << label << " " << consense << " " << rhs;
+// uniformly distributed number in [0,1) that only depends on the seed and the index of the derivation,
+// so that the result does not depend on how the derivations are distributed over the threads
+static double randomFraction(unsigned long long seed, size_t index)
+{
+   // splitmix64
+   unsigned long long z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   z = z ^ (z >> 31);
 
-      // get derived constraints
-      certificateFile >> numberOfCoefficients;
+   return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// writes the derivation to out; lin derivations that are selected are made incomplete or weak
+static bool incompletifyDerivation(const string &text, size_t derIdx, string &out, string &error)
+{
+   TokenCursor cur(text);
+   string tok, numberOfCoefficients, kind;
+   bool incomplete = (incomptype == "incomplete");
+   bool incompleteObj = (incompobj == "all");
 
-      if (numberOfCoefficients == "OBJ")
+   auto _copy = [&cur, &out, &tok]( long count )
+   {
+      for( long j = 0; j < count && cur.next(tok); ++j )
       {
-         incompleteFile << " " << numberOfCoefficients;
+         out += ' ';
+         out += tok;
       }
-      else
+   };
+
+   out += "\r\n";
+   cur.next(tok);
+   out += tok;
+   _copy(2); // sense and rhs
+
+   // get derived constraints
+   cur.next(numberOfCoefficients);
+   out += ' ';
+   out += numberOfCoefficients;
+   if( numberOfCoefficients != "OBJ" )
+      _copy(2 * atol(numberOfCoefficients.c_str()));
+
+   // obtain derivation kind
+   cur.next(tok);
+   if( tok != "{" )
+   {
+      error = "Expecting { but read instead " + tok;
+      return false;
+   }
+   cur.next(kind);
+   out += " { ";
+   out += kind;
+
+   if( kind == "lin" )
+   {
+      string a_i, val;
+      bool makeincomplete = randomFraction(seed, derIdx) * 100 < percentageIncomplete
+         && (numberOfCoefficients != "OBJ" || incompleteObj);
+
+      cur.next(tok);
+
+      // derivations that are already incomplete or weak are kept as they are
+      if( tok == "incomplete" || tok == "weak" )
       {
-         intOfCoefficients = atoi(numberOfCoefficients.c_str());
-         incompleteFile << " " << numberOfCoefficients;
-         for (long j = 0; j < intOfCoefficients; ++j)
+         out += ' ';
+         out += tok;
+         while( cur.next(tok) )
          {
-            certificateFile >> idx >> val;
-            incompleteFile << " " << idx << " " << val;
+            out += ' ';
+            out += tok;
          }
+         return true;
       }
 
-      // obtain derivation kind
-      certificateFile >> bracket >> kind;
+      if( makeincomplete )
+      {
+         if( incomplete )
+            out += " incomplete";
+         else
+         {
+            out += " weak { 0 }";
+            makeincomplete = false;
+         }
+      }
 
-      if (bracket != "{")
+      // incomplete derivations only list the active derivations, without their number
+      long numberOfDer = atol(tok.c_str());
+      if( !makeincomplete )
       {
-         cerr << "Expecting { but read instead " << bracket << endl;
-         returnStatement = false;
+         out += ' ';
+         out += tok;
       }
-      else
+
+      for( long i = 0; i < numberOfDer; ++i )
       {
-         if (kind == "asm")
+         cur.next(a_i);
+         cur.next(val);
+         if( makeincomplete )
          {
-
-            incompleteFile << " " + bracket + " " + kind;
-            string bracket;
-            long derHierarchy;
-            certificateFile >> bracket;
-            if (bracket != "}")
+            if( atol(a_i.c_str()) >= numberOfConstraints )
             {
-               cerr << "Expecting } but read instead" << bracket << endl;
-               returnStatement = false;
+               out += ' ';
+               out += a_i;
             }
-            else
-            {
-               incompleteFile << " " + bracket;
-               certificateFile >> derHierarchy;
-               incompleteFile << " " << derHierarchy;
-               returnStatement = true;
-            }
-            returnStatement = true;
          }
-
-         else if (kind == "lin")
+         else
          {
-            long numberOfDer;
-            long a_i;
-            string todelete;
-            bool makeincomplete = distrib(gen) <= percentageIncomplete;
+            out += ' ';
+            out += a_i;
+            out += ' ';
+            out += val;
+         }
+      }
+   }
+   else if( kind != "asm" && kind != "rnd" && kind != "uns" )
+   {
+      error = "Unknown reason " + kind + ". Nothing to complete.";
+      return false;
+   }
 
-            incompleteFile << " " + bracket + " " + kind;
+   // the rest of the reason and the index after it are copied; readDerivation ensures the closing brace
+   while( cur.next(tok) )
+   {
+      out += ' ';
+      out += tok;
+   }
 
-            if( makeincomplete && (numberOfCoefficients != "OBJ" || incompleteObj) )
-            {
-               if( incomplete )
-                  incompleteFile << " incomplete";
-               else
-               {
-                  incompleteFile << " weak { 0 } ";
-                  makeincomplete = false;
-               }
-            }
+   return true;
+}
+
+bool processDER()
+{
+   bool returnStatement = false;
+   string section;
+   long numberOfDerivations;
+   timeval start, end;
+
+   std::cout << endl
+        << "Processing DER section... " << endl;
+   certificateFile >> section;
+
+   if (section != "DER")
+   {
+      cerr << "DER expected.   Read instead " << section << endl;
+      return false;
+   }
+
+   incompleteFile << "\r\n" + section;
+
+   certificateFile >> numberOfDerivations;
+   incompleteFile << " " + to_string(numberOfDerivations);
+
+   if (numberOfDerivations == 0)
+   {
+      cout << "Number of derivations = 0. Nothing to complete." << endl;
+      return true;
+   }
 
-            certificateFile >> numberOfDer;
-            incompleteFile << " " << numberOfDer;
+   cout << "Available threads: " << nthreads << ", seed " << seed << endl;
 
-            if( numberOfCoefficients == "OBJ" && !incompleteObj )
+   gettimeofday(&start, 0);
+
+   // derivations are read sequentially in chunks, rewritten in parallel and written in order
+   struct Chunk
+   {
+      long begin;
+      vector<string> texts;
+      string out;
+      string error;
+   };
+
+   const long chunkSize = 1024;
+   long numRead = 0;
+   atomic<bool> failed(false);
+   string error;
+   tbb::task_arena limitedArena(nthreads);
+
+   limitedArena.execute([&]() {
+      tbb::parallel_pipeline(2 * nthreads,
+         tbb::make_filter<void, Chunk>( tbb::filter_mode::serial_in_order,
+            [&]( tbb::flow_control &fc )
             {
-               for (long i = 0; i < numberOfDer; ++i)
+               Chunk chunk;
+
+               chunk.begin = numRead;
+               if( numRead == numberOfDerivations || failed )
                {
-                  certificateFile >> a_i >> todelete;
-                  incompleteFile << " " << a_i << " " << todelete;
+                  fc.stop();
+                  return chunk;
                }
-            }
-            else
-            {
-               for (long i = 0; i < numberOfDer; ++i)
+
+               while( numRead < numberOfDerivations && (long) chunk.texts.size() < chunkSize )
                {
-                  certificateFile >> a_i >> todelete;
-                  if (makeincomplete)
+                  chunk.texts.emplace_back();
+                  if( !readDerivation(certificateFile, chunk.texts.back()) )
                   {
-                     if (a_i >= numberOfConstraints)
-                        incompleteFile << " " << a_i;
+                     chunk.texts.pop_back();
+                     chunk.error = "Error reading derivation " + to_string(numRead);
+                     numRead = numberOfDerivations;
+                     break;
                   }
-                  else
-                     incompleteFile << " " << a_i << " " << todelete;
+                  ++numRead;
                }
-            }
-            certificateFile >> bracket >> derHir;
-            incompleteFile << " " << bracket << " " << derHir;
-            returnStatement = true;
-         }
-         else if (kind == "rnd")
-         {
-
-            incompleteFile << " " + bracket + " " + kind;
 
-            long numberOfCoefficients, idx, dernr;
-            Rational val;
-            string bracket;
-
-            certificateFile >> numberOfCoefficients;
-            incompleteFile << " " << numberOfCoefficients;
-
-            for (int i = 0; i < numberOfCoefficients; ++i)
-            {
-               certificateFile >> idx >> val;
-               incompleteFile << " " + to_string(idx) + " " << val;
-            }
-
-            certificateFile >> bracket;
-            if (bracket != "}")
+               return chunk;
+            } ) &
+         tbb::make_filter<Chunk, Chunk>( tbb::filter_mode::parallel,
+            [&]( Chunk chunk )
             {
-               cerr << "Expecting } but read instead" << bracket << endl;
-               returnStatement = false;
-            }
-            else
+               for( size_t i = 0; i < chunk.texts.size() && chunk.error.empty(); ++i )
+               {
+                  if( !incompletifyDerivation(chunk.texts[i], chunk.begin + i, chunk.out, chunk.error) )
+                     chunk.error += " (derivation " + to_string(chunk.begin + i) + ")";
+               }
+               chunk.texts.clear();
+               return chunk;
+            } ) &
+         tbb::make_filter<Chunk, void>( tbb::filter_mode::serial_in_order,
+            [&]( Chunk chunk )
             {
-               incompleteFile << " " + bracket;
-               certificateFile >> dernr;
-               incompleteFile << " " + to_string(dernr);
-               returnStatement = true;
-            }
-            returnStatement = true;
-         }
+               if( failed ) return;
 
-         else if (kind == "uns")
-         {
+               if( !chunk.error.empty() )
+               {
+                  error = chunk.error;
+                  failed = true;
+                  return;
+               }
 
-            incompleteFile << " " + bracket + " " + kind;
+               incompleteFile << chunk.out;
+            } ) );
+   });
 
-            long i1, l1, i2, l2, dernr;
-            string bracket;
+   if( failed )
+   {
+      cerr << error << endl;
+      return false;
+   }
 
-            certificateFile >> i1 >> l1 >> i2 >> l2;
-            incompleteFile << " " + to_string(i1) + " " + to_string(l1) +
-                                  " " + to_string(i2) + " " + to_string(l2);
+   gettimeofday(&end, 0);
+   cout << "Rewrote " << numberOfDerivations << " derivations in " << getTimeSecs(start, end)
+        << " seconds (Wall Clock)" << endl;
 
-            certificateFile >> bracket;
-            if (bracket != "}")
-            {
-               cerr << "Expecting } but read instead" << bracket << endl;
-               returnStatement = false;
-            }
-            else
-            {
-               incompleteFile << " " + bracket;
-               certificateFile >> dernr;
-               incompleteFile << " " + to_string(dernr);
-               returnStatement = true;
-            }
-            returnStatement = true;
-         }
-         else
-         {
-            cerr << "Unknown reason. Nothing to complete." << endl;
-            returnStatement = false;
-         }
-      }
-   }
+   returnStatement = true;
    return returnStatement;
 }
@@ -0,0 +1,336 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Instrumentation shared by viprchk, viprchk_parallel and viprcomp
+//
+// The wall clock time of every section of a certificate is recorded as a phase,
+// counters (derivations by type, nonzeros, fallbacks of the exact arithmetic, LP
+// solves) are collected by name, and long phases report their progress with
+// throughput and an estimate of the remaining time. At the end, everything is
+// written as JSON for --stats=<file>, so that slow certificate shapes can be found
+// and jobs can be sized.
+//
+// A Stats object is used by one thread; multi-threaded tools sum up their
+// per-thread counts and hand over the totals.
+
+#ifndef _VIPR_STATS_HPP_
+#define _VIPR_STATS_HPP_
+
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+class Stats
+{
+   public:
+      Stats() { _start = _now(); }
+
+      // ends the running phase and starts the one of the given name
+      void startPhase(const std::string &name);
+
+      // ends the running phase
+      void endPhase();
+
+      // adds value to a counter, counters start at 0
+      void add(const std::string &counter, long long value = 1);
+
+      // sets a counter
+      void set(const std::string &counter, long long value);
+
+      // records a string, e.g. the certificate or the result
+      void setInfo(const std::string &key, const std::string &value);
+
+      // seconds between two progress lines, 0 switches them off
+      void setProgressInterval(double seconds) { _progressInterval = seconds; }
+
+      // throughput counts from done on, e.g. after resuming from a checkpoint
+      void startProgress(long long done);
+
+      // prints a progress line for done of total units if the last one is long enough ago
+      void progress(long long done, long long total, const char* unit, std::ostream &out);
+
+      // seconds since construction
+      double elapsed() const { return _now() - _start; }
+
+      // peak resident set size in kilobytes, 0 if unknown
+      static long peakRSS();
+
+      // writes all collected statistics as JSON, returns false if the file cannot be written
+      bool writeJSON(const char* filename, std::ostream &err);
+
+   private:
+      double _start;
+      std::vector<std::pair<std::string, double> > _phases; // name and seconds, in order
+      std::vector<std::pair<std::string, long long> > _counters;
+      std::vector<std::pair<std::string, std::string> > _info;
+      std::string _phase; // running phase, empty if none
+      double _phaseStart = 0.0;
+
+      double _progressInterval = 0.0;
+      double _progressStart = -1.0; // time and amount throughput is measured from
+      long long _progressBase = 0;
+      double _lastProgress = 0.0;
+
+      static double _now();
+      static void _writeString(std::ostream &out, const std::string &s);
+};
+
+
+inline double Stats::_now()
+{
+#ifndef _WIN32
+   struct timeval now;
+   gettimeofday( &now, 0 );
+   return now.tv_sec + now.tv_usec / 1e6;
+#else
+   return std::clock() / (double) CLOCKS_PER_SEC;
+#endif
+}
+
+
+inline void Stats::startPhase(const std::string &name)
+{
+   endPhase();
+   _phase = name;
+   _phaseStart = _now();
+   _progressStart = -1.0;
+}
+
+
+inline void Stats::endPhase()
+{
+   if( _phase.empty() )
+      return;
+
+   double seconds = _now() - _phaseStart;
+
+   for( auto &phase : _phases )
+   {
+      if( phase.first == _phase )
+      {
+         phase.second += seconds;
+         _phase.clear();
+         return;
+      }
+   }
+
+   _phases.emplace_back(_phase, seconds);
+   _phase.clear();
+}
+
+
+inline void Stats::add(const std::string &counter, long long value)
+{
+   for( auto &c : _counters )
+   {
+      if( c.first == counter )
+      {
+         c.second += value;
+         return;
+      }
+   }
+
+   _counters.emplace_back(counter, value);
+}
+
+
+inline void Stats::set(const std::string &counter, long long value)
+{
+   for( auto &c : _counters )
+   {
+      if( c.first == counter )
+      {
+         c.second = value;
+         return;
+      }
+   }
+
+   _counters.emplace_back(counter, value);
+}
+
+
+inline void Stats::setInfo(const std::string &key, const std::string &value)
+{
+   for( auto &i : _info )
+   {
+      if( i.first == key )
+      {
+         i.second = value;
+         return;
+      }
+   }
+
+   _info.emplace_back(key, value);
+}
+
+
+inline void Stats::startProgress(long long done)
+{
+   _progressStart = _now();
+   _progressBase = done;
+   _lastProgress = _progressStart;
+}
+
+
+inline void Stats::progress(long long done, long long total, const char* unit, std::ostream &out)
+{
+   if( _progressInterval <= 0.0 )
+      return;
+
+   double now = _now();
+
+   if( _progressStart < 0.0 )
+   {
+      // first call of the phase, measure from its start
+      _progressStart = _phase.empty() ? _start : _phaseStart;
+      _progressBase = 0;
+      _lastProgress = _progressStart;
+   }
+
+   if( now - _lastProgress < _progressInterval )
+      return;
+
+   _lastProgress = now;
+
+   double rate = (done - _progressBase) / std::max(now - _progressStart, 1e-9);
+   std::ios::fmtflags flags = out.flags();
+   std::streamsize precision = out.precision();
+
+   out << std::fixed << std::setprecision(1) << "Progress: " << done << "/" << total << " " << unit
+       << " (" << (total > 0 ? 100.0 * done / total : 100.0) << "%), "
+       << std::setprecision(0) << rate << " " << unit << "/s";
+   if( rate > 0.0 && total >= done )
+      out << ", ETA " << (total - done) / rate << " s";
+   out << ", peak RSS " << peakRSS() / 1024 << " MB" << std::endl;
+
+   out.flags(flags);
+   out.precision(precision);
+}
+
+
+inline long Stats::peakRSS()
+{
+#ifndef _WIN32
+   struct rusage usage;
+
+   if( getrusage(RUSAGE_SELF, &usage) == 0 )
+#ifdef __APPLE__
+      return usage.ru_maxrss / 1024;
+#else
+      return usage.ru_maxrss;
+#endif
+#endif
+   return 0;
+}
+
+
+inline void Stats::_writeString(std::ostream &out, const std::string &s)
+{
+   out << '"';
+   for( char c : s )
+   {
+      if( c == '"' || c == '\\' )
+         out << '\\' << c;
+      else if( (unsigned char) c < 0x20 )
+      {
+         char escaped[8];
+         snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char) c);
+         out << escaped;
+      }
+      else
+         out << c;
+   }
+   out << '"';
+}
+
+
+inline bool Stats::writeJSON(const char* filename, std::ostream &err)
+{
+   endPhase();
+
+   std::ofstream out(filename);
+
+   if( !out )
+   {
+      err << "Failed to write statistics to " << filename << std::endl;
+      return false;
+   }
+
+   double cpuSeconds = std::clock() / (double) CLOCKS_PER_SEC;
+
+   out << std::setprecision(6) << "{" << std::endl;
+   for( auto &i : _info )
+   {
+      out << "  ";
+      _writeString(out, i.first);
+      out << ": ";
+      _writeString(out, i.second);
+      out << "," << std::endl;
+   }
+
+   out << "  \"wall_seconds\": " << elapsed() << "," << std::endl;
+   out << "  \"cpu_seconds\": " << cpuSeconds << "," << std::endl;
+   out << "  \"peak_rss_kb\": " << peakRSS() << "," << std::endl;
+
+   out << "  \"phases\": {";
+   for( size_t p = 0; p < _phases.size(); ++p )
+   {
+      out << (p == 0 ? "" : ",") << std::endl << "    ";
+      _writeString(out, _phases[p].first);
+      out << ": " << _phases[p].second;
+   }
+   out << (_phases.empty() ? "" : "\n  ") << "}," << std::endl;
+
+   out << "  \"counters\": {";
+   for( size_t c = 0; c < _counters.size(); ++c )
+   {
+      out << (c == 0 ? "" : ",") << std::endl << "    ";
+      _writeString(out, _counters[c].first);
+      out << ": " << _counters[c].second;
+   }
+   out << (_counters.empty() ? "" : "\n  ") << "}" << std::endl;
+   out << "}" << std::endl;
+
+   if( !out )
+   {
+      err << "Failed to write statistics to " << filename << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+#endif
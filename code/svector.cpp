@@ -0,0 +1,497 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+#include "svector.hpp"
+
+using std::vector;
+using std::pair;
+
+namespace vipr
+{
+
+// SVectorGMP methods
+// binary search for index, 0 if not present
+mpq_class SVectorGMP::get(const int index) const
+{
+   auto it = std::lower_bound(_indices.begin(), _indices.end(), index);
+
+   if( it != _indices.end() && *it == index )
+      return _values[it - _indices.begin()];
+   else
+      return mpq_class(0);
+}
+
+
+void SVectorGMP::compactify()
+{
+   if( _compact )
+      return;
+
+   bool sorted = true;
+   for( size_t k = 1; k < _indices.size() && sorted; ++k )
+      sorted = (_indices[k-1] < _indices[k]);
+
+   if( !sorted )
+   {
+      // sort (index, position) pairs, the position keeps the order of duplicates stable
+      vector<pair<int, size_t>> perm(_indices.size());
+      for( size_t k = 0; k < perm.size(); ++k )
+         perm[k] = std::make_pair(_indices[k], k);
+
+      std::sort(perm.begin(), perm.end());
+
+      vector<int> indices;
+      vector<mpq_class> values;
+      indices.reserve(perm.size());
+      values.reserve(perm.size());
+
+      for( size_t k = 0; k < perm.size(); ++k )
+      {
+         if( !indices.empty() && indices.back() == perm[k].first )
+            values.back() += _values[perm[k].second];
+         else
+         {
+            indices.push_back(perm[k].first);
+            values.push_back(std::move(_values[perm[k].second]));
+         }
+      }
+
+      _indices.swap(indices);
+      _values.swap(values);
+   }
+
+   // remove zeros
+   size_t nnz = 0;
+   for( size_t k = 0; k < _indices.size(); ++k )
+   {
+      if( _values[k] == 0 )
+         continue;
+
+      if( nnz != k )
+      {
+         _indices[nnz] = _indices[k];
+         _values[nnz] = std::move(_values[k]);
+      }
+      ++nnz;
+   }
+   _indices.resize(nnz);
+   _values.resize(nnz);
+
+   _fingerprint = 0;
+   for( auto index : _indices )
+      _fingerprint = (_fingerprint ^ (size_t) index) * 1099511628211UL;
+
+   _compact = true;
+}
+
+
+bool SVectorGMP::operator!=(SVectorGMP &other)
+{
+   // get rid of all zero entries
+   compactify();
+   other.compactify();
+
+   // different supports are rejected by size and fingerprint without reading the entries
+   if( _indices.size() != other._indices.size() || _fingerprint != other._fingerprint )
+      return true;
+
+   return (_indices != other._indices) || (_values != other._values);
+}
+
+
+// both vectors are sorted by index, so the common support is found by merging
+mpq_class scalarProduct(const SVectorGMP &u, const SVectorGMP &v, ArithmeticCounts &counts)
+{
+   HybridRational product;
+   mpq_class result;
+   size_t k = 0, l = 0;
+
+   while( k < u.size() && l < v.size() )
+   {
+      if( u.index(k) < v.index(l) )
+         ++k;
+      else if( u.index(k) > v.index(l) )
+         ++l;
+      else
+      {
+         product.addProduct(u.value(k), v.value(l), counts);
+         ++k;
+         ++l;
+      }
+   }
+
+   product.get(result);
+   return result;
+}
+
+
+// zero entries of x are skipped
+mpq_class denseActivity(const SVectorGMP &row, const vector<mpq_class> &x, ArithmeticCounts &counts)
+{
+   HybridRational product;
+   mpq_class result;
+
+   for( size_t k = 0; k < row.size(); ++k )
+   {
+      const mpq_class &value = x[row.index(k)];
+
+      if( sgn(value) != 0 )
+         product.addProduct(row.value(k), value, counts);
+   }
+
+   product.get(result);
+   return result;
+}
+
+
+// HybridRational methods
+// overflow-checked 64-bit arithmetic; the portable versions may also report overflow for a result
+// of INT64_MIN, which is rejected anyway since it has no positive counterpart
+static inline bool mulOverflow(int64_t a, int64_t b, int64_t &result)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return __builtin_mul_overflow(a, b, &result);
+#else
+   uint64_t x = (a < 0) ? 0 - (uint64_t) a : (uint64_t) a;
+   uint64_t y = (b < 0) ? 0 - (uint64_t) b : (uint64_t) b;
+
+   if( y != 0 && x > (uint64_t) INT64_MAX / y )
+      return true;
+
+   result = a * b;
+   return false;
+#endif
+}
+
+
+static inline bool addOverflow(int64_t a, int64_t b, int64_t &result)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return __builtin_add_overflow(a, b, &result);
+#else
+   if( (b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b) )
+      return true;
+
+   result = a + b;
+   return false;
+#endif
+}
+
+
+// value of z as 64-bit integer, false if it does not fit; long has only 32 bits on Windows
+static inline bool getInt64(mpz_srcptr z, int64_t &value)
+{
+   if( mpz_fits_slong_p(z) )
+   {
+      value = mpz_get_si(z);
+      return true;
+   }
+
+   if( mpz_sizeinbase(z, 2) > 63 )
+      return false;
+
+   uint64_t magnitude = 0;
+
+   mpz_export(&magnitude, nullptr, -1, sizeof(magnitude), 0, 0, z);
+   value = (mpz_sgn(z) < 0) ? -(int64_t) magnitude : (int64_t) magnitude;
+
+   return true;
+}
+
+
+static inline void setInt64(mpz_ptr z, int64_t value)
+{
+   if( value >= LONG_MIN && value <= LONG_MAX )
+      mpz_set_si(z, (long) value);
+   else
+   {
+      uint64_t magnitude = (value < 0) ? 0 - (uint64_t) value : (uint64_t) value;
+
+      mpz_import(z, 1, -1, sizeof(magnitude), 0, 0, &magnitude);
+      if( value < 0 )
+         mpz_neg(z, z);
+   }
+}
+
+
+// value of q as 64-bit numerator and denominator, false if it does not fit
+static inline bool toSmall(const mpq_class &q, int64_t &num, int64_t &den)
+{
+   if( !getInt64(q.get_num_mpz_t(), num) || !getInt64(q.get_den_mpz_t(), den) )
+      return false;
+
+   // INT64_MIN has no positive counterpart
+   return num != INT64_MIN;
+}
+
+
+static inline int64_t gcdSmall(int64_t a, int64_t b)
+{
+   uint64_t x = (a < 0) ? 0 - (uint64_t) a : (uint64_t) a;
+   uint64_t y = (b < 0) ? 0 - (uint64_t) b : (uint64_t) b;
+
+   while( y != 0 )
+   {
+      uint64_t t = x % y;
+      x = y;
+      y = t;
+   }
+
+   return (int64_t) x;
+}
+
+
+// adds num/den (den > 0) to the small representation, false and unchanged on overflow
+bool HybridRational::_addSmall(int64_t num, int64_t den)
+{
+   int64_t g = gcdSmall(_den, den);
+   int64_t t1, t2, sum, newDen;
+
+   if( mulOverflow(_num, den / g, t1)
+      || mulOverflow(num, _den / g, t2)
+      || addOverflow(t1, t2, sum)
+      || mulOverflow(_den / g, den, newDen)
+      || sum == INT64_MIN )
+      return false;
+
+   g = gcdSmall(sum, newDen);
+   _num = sum / g;
+   _den = newDen / g;
+
+   return true;
+}
+
+
+// adds a * b, exactly
+void HybridRational::addProduct(const mpq_class &a, const mpq_class &b, ArithmeticCounts &counts)
+{
+   int64_t an, ad, bn, bd;
+
+   if( !_isBig && toSmall(a, an, ad) && toSmall(b, bn, bd) )
+   {
+      int64_t pn, pd;
+
+      if( an == 0 || bn == 0 )
+      {
+         ++counts.fast;
+         return;
+      }
+
+      // cancel crosswise before multiplying to keep the numbers small
+      int64_t g1 = gcdSmall(an, bd);
+      int64_t g2 = gcdSmall(bn, ad);
+
+      if( !mulOverflow(an / g1, bn / g2, pn)
+         && !mulOverflow(ad / g2, bd / g1, pd)
+         && pn != INT64_MIN
+         && _addSmall(pn, pd) )
+      {
+         ++counts.fast;
+         return;
+      }
+   }
+
+   if( !_isBig )
+   {
+      setInt64(_bigNum.get_mpz_t(), _num);
+      setInt64(_bigDen.get_mpz_t(), _den);
+      _isBig = true;
+   }
+
+   ++counts.fallback;
+   _addBig(a, b);
+}
+
+
+// adds a * b over a common denominator; the unreduced product needs no gcd and its
+// denominator usually divides the common one, otherwise only the denominators are reduced
+void HybridRational::_addBig(const mpq_class &a, const mpq_class &b)
+{
+   static thread_local mpz_class num, den;
+
+   mpz_mul(num.get_mpz_t(), a.get_num_mpz_t(), b.get_num_mpz_t());
+   mpz_mul(den.get_mpz_t(), a.get_den_mpz_t(), b.get_den_mpz_t());
+
+   if( mpz_cmp(den.get_mpz_t(), _bigDen.get_mpz_t()) == 0 )
+      mpz_add(_bigNum.get_mpz_t(), _bigNum.get_mpz_t(), num.get_mpz_t());
+   else if( mpz_divisible_p(_bigDen.get_mpz_t(), den.get_mpz_t()) )
+   {
+      mpz_divexact(den.get_mpz_t(), _bigDen.get_mpz_t(), den.get_mpz_t());
+      mpz_addmul(_bigNum.get_mpz_t(), num.get_mpz_t(), den.get_mpz_t());
+   }
+   else
+   {
+      // extend to the least common multiple of both denominators
+      static thread_local mpz_class g;
+
+      mpz_gcd(g.get_mpz_t(), _bigDen.get_mpz_t(), den.get_mpz_t());
+      mpz_divexact(den.get_mpz_t(), den.get_mpz_t(), g.get_mpz_t());
+      mpz_mul(_bigNum.get_mpz_t(), _bigNum.get_mpz_t(), den.get_mpz_t());
+      mpz_divexact(g.get_mpz_t(), _bigDen.get_mpz_t(), g.get_mpz_t());
+      mpz_addmul(_bigNum.get_mpz_t(), num.get_mpz_t(), g.get_mpz_t());
+      mpz_mul(_bigDen.get_mpz_t(), _bigDen.get_mpz_t(), den.get_mpz_t());
+   }
+}
+
+
+void HybridRational::_canonicalize()
+{
+   static thread_local mpz_class g;
+
+   mpz_gcd(g.get_mpz_t(), _bigNum.get_mpz_t(), _bigDen.get_mpz_t());
+   if( mpz_cmp_ui(g.get_mpz_t(), 1) != 0 )
+   {
+      mpz_divexact(_bigNum.get_mpz_t(), _bigNum.get_mpz_t(), g.get_mpz_t());
+      mpz_divexact(_bigDen.get_mpz_t(), _bigDen.get_mpz_t(), g.get_mpz_t());
+   }
+}
+
+
+// canonicalizes once and stores the value in result
+void HybridRational::get(mpq_class &result)
+{
+   if( _isBig )
+   {
+      _canonicalize();
+      mpq_set_num(result.get_mpq_t(), _bigNum.get_mpz_t());
+      mpq_set_den(result.get_mpq_t(), _bigDen.get_mpz_t());
+   }
+   else
+   {
+      setInt64(mpq_numref(result.get_mpq_t()), _num);
+      setInt64(mpq_denref(result.get_mpq_t()), _den);
+   }
+}
+
+
+// both representations are canonical, so a small value only equals a small q with the same
+// numerator and denominator
+bool HybridRational::equals(const mpq_class &q)
+{
+   int64_t num, den;
+
+   if( !_isBig )
+      return toSmall(q, num, den) && num == _num && den == _den;
+
+   _canonicalize();
+   return mpz_cmp(_bigNum.get_mpz_t(), q.get_num_mpz_t()) == 0
+      && mpz_cmp(_bigDen.get_mpz_t(), q.get_den_mpz_t()) == 0;
+}
+
+
+// DenseAccumulator methods
+void DenseAccumulator::resize(const size_t n)
+{
+   if( _values.size() != n )
+   {
+      _values.assign(n, HybridRational());
+      _isTouched.assign(n, 0);
+      _touched.clear();
+   }
+}
+
+
+// adds a * b to entry index
+void DenseAccumulator::addProduct(const int index, const mpq_class &a, const mpq_class &b,
+      ArithmeticCounts &counts)
+{
+   _values[index].addProduct(a, b, counts);
+
+   if( !_isTouched[index] )
+   {
+      _isTouched[index] = 1;
+      _touched.push_back(index);
+   }
+}
+
+
+// appends the nonzero entries in order of increasing index to result and resets the accumulator
+void DenseAccumulator::gather(SVectorGMP &result)
+{
+   // scanning the dense array is cheaper than sorting many touched indices
+   if( 8 * _touched.size() > _values.size() )
+   {
+      _touched.clear();
+      for( size_t j = 0; j < _values.size(); ++j )
+         if( _isTouched[j] )
+            _touched.push_back(j);
+   }
+   else
+      std::sort(_touched.begin(), _touched.end());
+
+   result.reserve(result.size() + _touched.size());
+   for( auto index : _touched )
+   {
+      if( !_values[index].isZero() )
+      {
+         mpq_class value;
+         _values[index].get(value);
+         result.push_back(index, std::move(value));
+      }
+      _values[index].setZero();
+      _isTouched[index] = 0;
+   }
+   _touched.clear();
+}
+
+
+// true iff the accumulated vector equals the compact vector target; then the accumulator is
+// reset, otherwise it is kept for gather
+// Compares in place, so that an exact match needs neither sorting nor GMP copies of the entries
+bool DenseAccumulator::matches(const SVectorGMP &target)
+{
+   size_t nonzeros = 0;
+
+   for( auto index : _touched )
+      if( !_values[index].isZero() )
+         ++nonzeros;
+
+   if( nonzeros != target.size() )
+      return false;
+
+   for( size_t k = 0; k < target.size(); ++k )
+   {
+      int index = target.index(k);
+
+      if( !_isTouched[index] || !_values[index].equals(target.value(k)) )
+         return false;
+   }
+
+   for( auto index : _touched )
+   {
+      _values[index].setZero();
+      _isTouched[index] = 0;
+   }
+   _touched.clear();
+
+   return true;
+}
+
+} // namespace vipr
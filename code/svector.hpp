@@ -0,0 +1,175 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Sparse vectors of exact rationals and the arithmetic the checkers combine them with
+//
+// Shared by viprchk (libvipr) and viprchk_parallel: sums of products are kept on 64-bit
+// integers as long as they fit and fall back to GMP otherwise, and linear combinations
+// of sparse rows are accumulated densely over the variables.
+
+#ifndef _VIPR_SVECTOR_HPP_
+#define _VIPR_SVECTOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+
+namespace vipr
+{
+
+// Sparse vectors of rational numbers as sorted index and value arrays
+// Entries may be appended in any order, compactify() sorts them by index, adds up
+// duplicate indices and removes zeros; all read access requires a compact vector
+class SVectorGMP
+{
+   public:
+      // read-only view of one entry, accessed like a map entry by it->first and it->second
+      struct Entry
+      {
+         const int first;
+         const mpq_class &second;
+         const Entry* operator->() const { return this; }
+      };
+
+      class const_iterator
+      {
+         public:
+            const_iterator(const SVectorGMP *vec, size_t pos) : _vec(vec), _pos(pos) {}
+            Entry operator*() const { return Entry{_vec->_indices[_pos], _vec->_values[_pos]}; }
+            Entry operator->() const { return **this; }
+            const_iterator& operator++() { ++_pos; return *this; }
+            bool operator==(const const_iterator &other) const { return _pos == other._pos; }
+            bool operator!=(const const_iterator &other) const { return _pos != other._pos; }
+
+         private:
+            const SVectorGMP *_vec;
+            size_t _pos;
+      };
+
+      const_iterator begin() const { return const_iterator(this, 0); }
+      const_iterator end() const { return const_iterator(this, _indices.size()); }
+
+      size_t size() const { return _indices.size(); }
+      bool empty() const { return _indices.empty(); }
+      int index(size_t k) const { return _indices[k]; }
+      const mpq_class& value(size_t k) const { return _values[k]; }
+      const int* indices() const { return _indices.data(); }
+
+      void clear() { _indices.clear(); _values.clear(); _compact = true; _fingerprint = 0; }
+      void reserve(size_t n) { _indices.reserve(n); _values.reserve(n); }
+      void push_back(const int index, const mpq_class &value)
+      {
+         _indices.push_back(index);
+         _values.push_back(value);
+         _compact = false;
+      }
+      void push_back(const int index, mpq_class &&value)
+      {
+         _indices.push_back(index);
+         _values.push_back(std::move(value));
+         _compact = false;
+      }
+
+      mpq_class get(const int index) const;
+      void compactify();
+      bool operator!=(SVectorGMP &other);
+      bool operator==(SVectorGMP &other) { return !(*this != other);}
+      SVectorGMP operator-(const SVectorGMP &other) const
+      {
+         SVectorGMP returnsvec(*this);
+         returnsvec.reserve(size() + other.size());
+         for( size_t k = 0; k < other.size(); ++k )
+            returnsvec.push_back(other._indices[k], -other._values[k]);
+
+         returnsvec.compactify();
+         return returnsvec;
+      }
+
+   private:
+      std::vector<int> _indices;
+      std::vector<mpq_class> _values;
+      bool _compact = true;
+      size_t _fingerprint = 0; // hash of the indices of a compact vector
+};
+
+// Counts how often exact arithmetic could stay on 64-bit integers and how often it fell back to GMP
+struct ArithmeticCounts
+{
+   size_t fast = 0;
+   size_t fallback = 0;
+};
+
+// Exact rational number that is kept as reduced 64-bit numerator and denominator
+// as long as no overflow occurs and switches to GMP integers once it does
+// In GMP mode, the sum is kept over a common denominator and only canonicalized
+// when the value is read
+class HybridRational
+{
+   public:
+      void setZero() { _num = 0; _den = 1; _isBig = false; }
+      bool isZero() const { return _isBig ? (sgn(_bigNum) == 0) : (_num == 0); }
+      void addProduct(const mpq_class &a, const mpq_class &b, ArithmeticCounts &counts);
+      void get(mpq_class &result);
+      bool equals(const mpq_class &q);
+
+   private:
+      int64_t _num = 0;
+      int64_t _den = 1;
+      bool _isBig = false;
+      mpz_class _bigNum;
+      mpz_class _bigDen;
+
+      bool _addSmall(int64_t num, int64_t den);
+      void _addBig(const mpq_class &a, const mpq_class &b);
+      void _canonicalize();
+};
+
+// Dense accumulator for linear combinations of sparse vectors
+// Holds one entry per variable and the list of touched indices, so that a combination
+// costs O(nnz) and the buffers are reused across calls without allocations
+class DenseAccumulator
+{
+   public:
+      void resize(const size_t n);
+      void addProduct(const int index, const mpq_class &a, const mpq_class &b, ArithmeticCounts &counts);
+      void gather(SVectorGMP &result);
+      bool matches(const SVectorGMP &target);
+
+   private:
+      std::vector<HybridRational> _values;
+      std::vector<char> _isTouched;
+      std::vector<int> _touched;
+};
+
+// scalar product of two compact vectors
+mpq_class scalarProduct(const SVectorGMP &u, const SVectorGMP &v, ArithmeticCounts &counts);
+
+// activity of a compact row at a dense vector, e.g., a solution
+mpq_class denseActivity(const SVectorGMP &row, const std::vector<mpq_class> &x, ArithmeticCounts &counts);
+
+} // namespace vipr
+
+#endif
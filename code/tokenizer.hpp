@@ -0,0 +1,1765 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Whitespace tokenizer for VIPR certificates shared by all tools
+//
+// Regular files are memory-mapped, everything else (pipes, stdin) is read in large
+// blocks. Certificates that are already in memory or that are delivered by a callback
+// are read in the same way, so a certificate can be checked without a file. Tokens
+// are handed out as views into the buffer, integers and rationals are parsed
+// directly from the view without iostreams or temporary strings. The interface
+// mirrors the parts of std::ifstream used by the tools, so the stream member can be
+// replaced by a Tokenizer without touching the parsing code.
+//
+// Input compressed with gzip or zstd is recognized by its magic number and decompressed
+// on a separate thread, so reading, decompression and checking overlap.
+//
+// Binary certificates (see cert_spec_binary.md, written by vipr2bin) are recognized in
+// the same way. Their tokens are already typed, so integers and rationals are taken
+// over without parsing; strings, lines and positions behave as for the text format.
+
+#ifndef _VIPR_TOKENIZER_HPP_
+#define _VIPR_TOKENIZER_HPP_
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <ios>
+#include <iostream>
+#include <ostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gmpxx.h>
+
+#ifdef VIPR_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef VIPR_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A token as pointer and length into the buffer of the Tokenizer
+// Only valid until the next read from the Tokenizer
+struct TokenView
+{
+   const char* data = nullptr;
+   size_t size = 0;
+
+   std::string str() const { return std::string(data, size); }
+   bool operator==(const char* other) const { return strlen(other) == size && memcmp(data, other, size) == 0; }
+   bool operator!=(const char* other) const { return !(*this == other); }
+};
+
+// tags of the tokens in a binary certificate
+enum BinaryTag : unsigned char
+{
+   BINARY_END = 0, // end of the token stream, followed by the derivation offset table
+   BINARY_NEWLINE = 1, // line break of the text format
+   BINARY_STRING = 2, // varint length, bytes
+   BINARY_INT = 3, // zigzag varint
+   BINARY_RATIONAL = 4, // zigzag varint numerator, varint denominator > 1
+   BINARY_BIGRATIONAL = 5 // varint 2 * words + sign and 64-bit words of the numerator, varint words of the denominator
+};
+
+static const char binaryMagic[4] = { 'V', 'I', 'P', 'B' };
+static const unsigned char binaryVersion = 1;
+static const size_t binaryFooterSize = 12; // 64-bit little-endian offset of the table, magic
+
+
+// compression formats recognized from the first bytes of the input
+enum class Compression { NONE, GZIP, ZSTD };
+
+
+// Decompresses the input on a separate thread, which hands the output to the
+// reader in blocks through a bounded queue
+class Decompressor
+{
+   public:
+      Decompressor() {}
+      ~Decompressor() { stop(); }
+
+      Decompressor(const Decompressor&) = delete;
+      Decompressor& operator=(const Decompressor&) = delete;
+
+      static Compression detect(const char* data, size_t size);
+      static bool isSupported(Compression compression);
+      static const char* name(Compression compression);
+
+      // starts decompressing data followed by the rest of file (if not null); data is
+      // copied if a file is given, otherwise it has to stay valid until stop()
+      void start(Compression compression, const char* data, size_t size, std::FILE* file);
+      void stop();
+      bool isRunning() const { return _thread.joinable(); }
+
+      // copies up to n bytes of decompressed output, blocks until some output is available;
+      // returns 0 at the end of the input or on an error
+      size_t read(char* out, size_t n);
+
+      // message if decompression failed, only meaningful after read() returned 0
+      const std::string& error() const { return _error; }
+
+   private:
+      static const size_t _blockSize = 1 << 20;
+      static const size_t _maxBlocks = 8; // decompressed blocks waiting for the reader
+
+      Compression _compression = Compression::NONE;
+      const char* _data = nullptr; // input in memory
+      size_t _size = 0;
+      size_t _pos = 0;
+      std::FILE* _file = nullptr; // input read after the prefix
+      std::vector<char> _prefix;
+      std::vector<char> _inBuffer;
+
+      std::thread _thread;
+      std::mutex _mutex;
+      std::condition_variable _cond;
+      std::deque<std::vector<char>> _blocks;
+      bool _done = false;
+      bool _stop = false;
+      std::string _error;
+
+      std::vector<char> _current; // block the reader is copying from
+      size_t _currentPos = 0;
+
+      bool _nextInput(const char* &data, size_t &size);
+      bool _push(std::vector<char> &block, size_t filled);
+      void _run();
+      void _inflate(std::string &error);
+      void _decompressZstd(std::string &error);
+};
+
+
+inline Compression Decompressor::detect(const char* data, size_t size)
+{
+   const unsigned char* c = reinterpret_cast<const unsigned char*>(data);
+
+   if( size >= 2 && c[0] == 0x1f && c[1] == 0x8b )
+      return Compression::GZIP;
+   if( size >= 4 && c[0] == 0x28 && c[1] == 0xb5 && c[2] == 0x2f && c[3] == 0xfd )
+      return Compression::ZSTD;
+
+   return Compression::NONE;
+}
+
+
+inline bool Decompressor::isSupported(Compression compression)
+{
+   switch( compression )
+   {
+      case Compression::NONE:
+         return true;
+      case Compression::GZIP:
+#ifdef VIPR_WITH_ZLIB
+         return true;
+#else
+         return false;
+#endif
+      case Compression::ZSTD:
+#ifdef VIPR_WITH_ZSTD
+         return true;
+#else
+         return false;
+#endif
+   }
+
+   return false;
+}
+
+
+inline const char* Decompressor::name(Compression compression)
+{
+   switch( compression )
+   {
+      case Compression::GZIP:
+         return "gzip";
+      case Compression::ZSTD:
+         return "zstd";
+      default:
+         return "uncompressed";
+   }
+}
+
+
+inline void Decompressor::start(Compression compression, const char* data, size_t size, std::FILE* file)
+{
+   stop();
+
+   _compression = compression;
+   _file = file;
+   _pos = 0;
+
+   if( file != nullptr )
+   {
+      _prefix.assign(data, data + size);
+      _data = _prefix.data();
+      _inBuffer.resize(_blockSize);
+   }
+   else
+      _data = data;
+   _size = size;
+
+   _thread = std::thread(&Decompressor::_run, this);
+}
+
+
+inline void Decompressor::stop()
+{
+   if( _thread.joinable() )
+   {
+      {
+         std::lock_guard<std::mutex> lock(_mutex);
+         _stop = true;
+      }
+      _cond.notify_all();
+      _thread.join();
+   }
+
+   _blocks.clear();
+   _current.clear();
+   _currentPos = 0;
+   _done = false;
+   _stop = false;
+   _error.clear();
+}
+
+
+inline size_t Decompressor::read(char* out, size_t n)
+{
+   size_t copied = 0;
+
+   while( copied < n )
+   {
+      if( _currentPos == _current.size() )
+      {
+         std::unique_lock<std::mutex> lock(_mutex);
+
+         // return what we have instead of waiting for the next block
+         if( copied > 0 && _blocks.empty() )
+            break;
+
+         _cond.wait(lock, [this] { return !_blocks.empty() || _done; });
+
+         if( _blocks.empty() )
+            break;
+
+         _current.swap(_blocks.front());
+         _blocks.pop_front();
+         _currentPos = 0;
+         _cond.notify_all();
+      }
+
+      size_t chunk = std::min(n - copied, _current.size() - _currentPos);
+      memcpy(out + copied, _current.data() + _currentPos, chunk);
+      _currentPos += chunk;
+      copied += chunk;
+   }
+
+   return copied;
+}
+
+
+// returns the next piece of compressed input: the data given to start(), then blocks of the file
+inline bool Decompressor::_nextInput(const char* &data, size_t &size)
+{
+   if( _pos < _size )
+   {
+      // zlib takes at most UINT_MAX bytes at once
+      data = _data + _pos;
+      size = std::min(_size - _pos, (size_t) 1 << 30);
+      _pos += size;
+      return true;
+   }
+
+   if( _file == nullptr )
+      return false;
+
+   size = std::fread(_inBuffer.data(), 1, _inBuffer.size(), _file);
+   data = _inBuffer.data();
+
+   return size > 0;
+}
+
+
+// hands the first filled bytes of block to the reader and waits while the queue is full;
+// returns false if the decompressor is stopped
+inline bool Decompressor::_push(std::vector<char> &block, size_t filled)
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+
+   _cond.wait(lock, [this] { return _blocks.size() < _maxBlocks || _stop; });
+
+   if( _stop )
+      return false;
+
+   block.resize(filled);
+   _blocks.push_back(std::move(block));
+   block = std::vector<char>(_blockSize);
+   _cond.notify_all();
+
+   return true;
+}
+
+
+inline void Decompressor::_run()
+{
+   std::string error;
+
+   try
+   {
+      if( _compression == Compression::GZIP )
+         _inflate(error);
+      else if( _compression == Compression::ZSTD )
+         _decompressZstd(error);
+   }
+   catch( const std::exception &e )
+   {
+      error = e.what();
+   }
+
+   if( error.empty() && _file != nullptr && std::ferror(_file) )
+      error = "read error";
+
+   {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _error = error;
+      _done = true;
+   }
+   _cond.notify_all();
+}
+
+
+// gzip, concatenated members (as written by pigz or cat) are decompressed one after the other
+inline void Decompressor::_inflate(std::string &error)
+{
+#ifdef VIPR_WITH_ZLIB
+   z_stream stream;
+   std::vector<char> block(_blockSize);
+   size_t filled = 0;
+   bool full = false;
+   bool ended = false;
+   bool stopped = false;
+   const char* data;
+   size_t size;
+
+   memset(&stream, 0, sizeof(stream));
+   if( inflateInit2(&stream, 15 + 16) != Z_OK )
+   {
+      error = "could not initialize zlib";
+      return;
+   }
+
+   while( true )
+   {
+      // zlib may hold back output if the last call filled the block
+      if( stream.avail_in == 0 && !full )
+      {
+         if( !_nextInput(data, size) )
+            break;
+         stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+         stream.avail_in = (uInt) size;
+      }
+
+      if( ended && stream.avail_in > 0 )
+      {
+         inflateReset(&stream);
+         ended = false;
+      }
+
+      stream.next_out = reinterpret_cast<Bytef*>(block.data() + filled);
+      stream.avail_out = (uInt) (block.size() - filled);
+
+      int status = inflate(&stream, Z_NO_FLUSH);
+
+      filled = block.size() - stream.avail_out;
+      full = (stream.avail_out == 0);
+
+      if( status == Z_STREAM_END )
+         ended = true;
+      else if( status != Z_OK && status != Z_BUF_ERROR )
+      {
+         error = (stream.msg != nullptr) ? stream.msg : "corrupt gzip data";
+         break;
+      }
+
+      if( full )
+      {
+         if( !_push(block, filled) )
+         {
+            stopped = true;
+            break;
+         }
+         filled = 0;
+      }
+   }
+
+   if( error.empty() && !stopped && !ended )
+      error = "unexpected end of gzip data";
+
+   if( !stopped && filled > 0 )
+      _push(block, filled);
+
+   inflateEnd(&stream);
+#else
+   error = "gzip support not available";
+#endif
+}
+
+
+// zstd, a file may consist of several frames
+inline void Decompressor::_decompressZstd(std::string &error)
+{
+#ifdef VIPR_WITH_ZSTD
+   ZSTD_DStream* stream = ZSTD_createDStream();
+   std::vector<char> block(_blockSize);
+   size_t filled = 0;
+   size_t status = 0;
+   bool full = false;
+   bool stopped = false;
+   ZSTD_inBuffer input = { nullptr, 0, 0 };
+   const char* data;
+   size_t size;
+
+   if( stream == nullptr || ZSTD_isError(ZSTD_initDStream(stream)) )
+   {
+      error = "could not initialize zstd";
+      ZSTD_freeDStream(stream);
+      return;
+   }
+
+   while( true )
+   {
+      // zstd may hold back output if the last call filled the block
+      if( input.pos == input.size && !full )
+      {
+         if( !_nextInput(data, size) )
+            break;
+         input.src = data;
+         input.size = size;
+         input.pos = 0;
+      }
+
+      ZSTD_outBuffer output = { block.data(), block.size(), filled };
+
+      status = ZSTD_decompressStream(stream, &output, &input);
+
+      if( ZSTD_isError(status) )
+      {
+         error = ZSTD_getErrorName(status);
+         break;
+      }
+
+      filled = output.pos;
+      full = (filled == block.size());
+
+      if( full )
+      {
+         if( !_push(block, filled) )
+         {
+            stopped = true;
+            break;
+         }
+         filled = 0;
+      }
+   }
+
+   if( error.empty() && !stopped && status != 0 )
+      error = "unexpected end of zstd data";
+
+   if( !stopped && filled > 0 )
+      _push(block, filled);
+
+   ZSTD_freeDStream(stream);
+#else
+   error = "zstd support not available";
+#endif
+}
+
+
+class Tokenizer
+{
+   public:
+      Tokenizer() {}
+      ~Tokenizer() { close(); }
+
+      Tokenizer(const Tokenizer&) = delete;
+      Tokenizer& operator=(const Tokenizer&) = delete;
+
+      // opens a file, "-" reads from stdin; compressed and binary input are recognized
+      void open(const char* filename);
+      void open(const std::string &filename) { open(filename.c_str()); }
+      // reads from memory that has to stay valid until the Tokenizer is closed
+      void openBuffer(const char* data, size_t size);
+      // reads blocks from a callback that fills the given buffer and returns the number of bytes
+      // written, 0 at the end of the input; compressed input is not supported this way
+      void openStream(const std::function<size_t(char*, size_t)> &read);
+      void close();
+      bool is_open() const { return _isOpen; }
+
+      // errors in the input, e.g. unsupported compression, are reported to err (std::cerr by default)
+      void setErrorStream(std::ostream &err) { _err = &err; }
+      bool isBinary() const { return _binary; }
+
+      // whether seekg() can go back to positions that are no longer buffered (not for pipes)
+      bool canSeek() const { return _mapped != nullptr || (_file != nullptr && _fileSeekable); }
+
+      bool fail() const { return _fail; }
+      bool eof() const { return _eof; }
+      bool good() const { return !_fail && !_eof; }
+      void clear() { _fail = false; _eof = false; }
+      explicit operator bool() const { return !_fail; }
+
+      // skips whitespace and returns the next token; sets fail at the end of input
+      bool nextToken(TokenView &token);
+      // skips whitespace and returns true if no token is left, without reading the next one
+      bool atEnd();
+
+      Tokenizer& operator>>(std::string &value);
+      Tokenizer& operator>>(char &value);
+      Tokenizer& operator>>(int &value) { return _readSigned(value); }
+      Tokenizer& operator>>(long &value) { return _readSigned(value); }
+      Tokenizer& operator>>(long long &value) { return _readSigned(value); }
+      Tokenizer& operator>>(unsigned int &value) { return _readUnsigned(value); }
+      Tokenizer& operator>>(unsigned long &value) { return _readUnsigned(value); }
+      Tokenizer& operator>>(unsigned long long &value) { return _readUnsigned(value); }
+      Tokenizer& operator>>(mpq_class &value);
+
+      // any other type is extracted from the token through a string stream
+      template <typename T>
+      Tokenizer& operator>>(T &value);
+
+      int peek();
+      Tokenizer& putback(char c);
+      Tokenizer& ignore(std::streamsize n = 1, int delim = EOF);
+      Tokenizer& getline(std::string &line);
+      Tokenizer& getline(char* line, std::streamsize n);
+
+      std::streampos tellg() { return _fail ? std::streampos(-1) : std::streampos(_offset + (_cur - _begin)); }
+      Tokenizer& seekg(std::streampos pos);
+
+      // writes the next n bytes of the input unchanged to out
+      Tokenizer& copyTo(std::ostream &out, std::streamsize n);
+
+      // reads the start positions of the derivations from a binary certificate; only
+      // available for uncompressed files, which can be accessed at random
+      bool readDerivationOffsets(std::vector<size_t> &offsets);
+
+      // parses a rational "p" or "p/q" from a string, returns false if it is malformed
+      static bool parseRational(const char* data, size_t size, mpq_class &value, std::string &scratch);
+
+   private:
+      static const size_t _blockSize = 1 << 22;
+
+      const char* _begin = nullptr; // start of the buffered part of the input
+      const char* _cur = nullptr; // current read position
+      const char* _end = nullptr; // end of the buffered part of the input
+      size_t _offset = 0; // offset of _begin in the input
+
+      bool _isOpen = false;
+      bool _fail = false;
+      bool _eof = false;
+      std::ostream* _err = &std::cerr;
+
+      void* _mapped = nullptr; // memory-mapped file or buffer given to openBuffer
+      size_t _mappedSize = 0;
+      bool _ownsMapping = false;
+      std::function<size_t(char*, size_t)> _read; // callback given to openStream
+      std::FILE* _file = nullptr; // block-wise read file if mapping is not possible
+      bool _ownsFile = false;
+      bool _fileSeekable = false;
+      std::vector<char> _buffer;
+
+      Compression _compression = Compression::NONE;
+      Decompressor _decompressor; // decompresses the mapped memory or the file
+
+      std::string _scratch; // to null-terminate long numbers for GMP
+      std::istringstream _stream; // for the generic extraction
+
+      // last token of a binary certificate
+      bool _binary = false;
+      unsigned char _tag = BINARY_END;
+      long long _intValue = 0; // integer or numerator of a small rational
+      unsigned long long _denValue = 1;
+      mpq_class _bigValue;
+      const char* _stringData = nullptr;
+      size_t _stringSize = 0;
+      size_t _tokenPos = 0; // input position of the token, for putback
+      char _number[48]; // text of a small number
+
+      static bool _isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+      void _open(const char* filename);
+      bool _startDecompression(Compression compression, const char* data, size_t size);
+      bool _refill();
+      bool _skipSpace();
+
+      bool _detectBinary();
+      bool _readVarint(unsigned long long &value);
+      bool _readWords(mpz_ptr value, size_t words);
+      bool _nextBinary();
+      void _binaryText(TokenView &token);
+      bool _truncateToNumber(TokenView &token, bool fraction);
+
+      template <typename T>
+      static bool _parseSigned(const char* data, size_t size, T &value);
+      template <typename T>
+      static bool _parseUnsigned(const char* data, size_t size, T &value);
+      template <typename T>
+      Tokenizer& _readSigned(T &value);
+      template <typename T>
+      Tokenizer& _readUnsigned(T &value);
+};
+
+
+// removes a trailing .gz or .zst, used to name uncompressed output files after the input
+inline std::string stripCompressionSuffix(const std::string &filename)
+{
+   for( const char* suffix : { ".gz", ".zst" } )
+   {
+      size_t length = strlen(suffix);
+
+      if( filename.size() > length && filename.compare(filename.size() - length, length, suffix) == 0 )
+         return filename.substr(0, filename.size() - length);
+   }
+
+   return filename;
+}
+
+
+// reads until the end of the line like std::getline
+inline Tokenizer& getline(Tokenizer &tokenizer, std::string &line)
+{
+   return tokenizer.getline(line);
+}
+
+
+inline void Tokenizer::open(const char* filename)
+{
+   _open(filename);
+
+   if( _isOpen && !_fail )
+      _detectBinary();
+}
+
+
+inline void Tokenizer::_open(const char* filename)
+{
+   close();
+   clear();
+
+   bool isStdin = (strcmp(filename, "-") == 0);
+
+#ifndef _WIN32
+   if( !isStdin )
+   {
+      int fd = ::open(filename, O_RDONLY);
+      struct stat st;
+
+      if( fd < 0 )
+      {
+         _fail = true;
+         return;
+      }
+
+      if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+      {
+         void* mapped = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+         if( mapped != MAP_FAILED )
+         {
+            madvise(mapped, (size_t) st.st_size, MADV_SEQUENTIAL);
+            _mapped = mapped;
+            _mappedSize = (size_t) st.st_size;
+            _ownsMapping = true;
+            _begin = _cur = static_cast<const char*>(mapped);
+            _end = _begin + _mappedSize;
+            _isOpen = true;
+         }
+      }
+      ::close(fd);
+
+      if( _isOpen )
+      {
+         Compression compression = Decompressor::detect(_begin, _mappedSize);
+
+         if( compression != Compression::NONE && !_startDecompression(compression, _begin, _mappedSize) )
+            close();
+         return;
+      }
+   }
+#endif
+
+   _file = isStdin ? stdin : std::fopen(filename, "rb");
+   _ownsFile = !isStdin;
+
+   if( _file == nullptr )
+   {
+      _fail = true;
+      return;
+   }
+
+   _fileSeekable = (std::ftell(_file) >= 0);
+
+   _buffer.resize(_blockSize);
+   _begin = _cur = _end = _buffer.data();
+   _isOpen = true;
+
+   // the magic number stays in the buffer for uncompressed input and is handed to the
+   // decompressor otherwise, so pipes work as well
+   char magic[4];
+   size_t n = std::fread(magic, 1, sizeof(magic), _file);
+   Compression compression = Decompressor::detect(magic, n);
+
+   if( compression == Compression::NONE )
+   {
+      memcpy(_buffer.data(), magic, n);
+      _end = _begin + n;
+   }
+   else if( !_startDecompression(compression, magic, n) )
+      close();
+}
+
+
+inline void Tokenizer::openBuffer(const char* data, size_t size)
+{
+   close();
+   clear();
+
+   _mapped = const_cast<char*>(data);
+   _mappedSize = size;
+   _begin = _cur = data;
+   _end = data + size;
+   _isOpen = true;
+
+   Compression compression = Decompressor::detect(_begin, _mappedSize);
+
+   if( compression != Compression::NONE && !_startDecompression(compression, _begin, _mappedSize) )
+      close();
+
+   if( _isOpen && !_fail )
+      _detectBinary();
+}
+
+
+inline void Tokenizer::openStream(const std::function<size_t(char*, size_t)> &read)
+{
+   close();
+   clear();
+
+   _read = read;
+   _buffer.resize(_blockSize);
+   _begin = _cur = _end = _buffer.data();
+   _isOpen = true;
+
+   // enough bytes for the magic number
+   for( size_t n = 1; n > 0 && _end - _begin < 4; _end += n )
+      n = _read(_buffer.data() + (_end - _begin), _buffer.size() - (_end - _begin));
+
+   if( Decompressor::detect(_begin, _end - _begin) != Compression::NONE )
+   {
+      *_err << "Compressed input has to be given as a file or a buffer" << std::endl;
+      close();
+      _fail = true;
+      return;
+   }
+
+   _detectBinary();
+}
+
+
+inline bool Tokenizer::_startDecompression(Compression compression, const char* data, size_t size)
+{
+   if( !Decompressor::isSupported(compression) )
+   {
+      *_err << "Input is " << Decompressor::name(compression) << " compressed, but "
+           << Decompressor::name(compression) << " support was not enabled at build time" << std::endl;
+      _fail = true;
+      return false;
+   }
+
+   _buffer.resize(_blockSize);
+   _begin = _cur = _end = _buffer.data();
+   _offset = 0;
+   _compression = compression;
+   _decompressor.start(compression, data, size, _file);
+
+   return true;
+}
+
+
+inline void Tokenizer::close()
+{
+   _decompressor.stop();
+   _compression = Compression::NONE;
+
+#ifndef _WIN32
+   if( _mapped != nullptr && _ownsMapping )
+      munmap(_mapped, _mappedSize);
+#endif
+   if( _file != nullptr && _ownsFile )
+      std::fclose(_file);
+
+   _mapped = nullptr;
+   _mappedSize = 0;
+   _ownsMapping = false;
+   _read = nullptr;
+   _file = nullptr;
+   _ownsFile = false;
+   _begin = _cur = _end = nullptr;
+   _offset = 0;
+   _isOpen = false;
+   _binary = false;
+}
+
+
+// moves the unread part to the front of the buffer and appends the next block;
+// returns false if no more input is available
+inline bool Tokenizer::_refill()
+{
+   if( _file == nullptr && !_read && _compression == Compression::NONE )
+      return false;
+
+   size_t remaining = _end - _cur;
+   size_t consumed = _cur - _begin;
+
+   // grow the buffer if a single token does not fit
+   if( remaining + _blockSize / 2 > _buffer.size() )
+      _buffer.resize(2 * _buffer.size());
+
+   memmove(_buffer.data(), _cur, remaining);
+   _offset += consumed;
+
+   size_t n;
+
+   if( _compression != Compression::NONE )
+   {
+      n = _decompressor.read(_buffer.data() + remaining, _buffer.size() - remaining);
+
+      if( n == 0 && !_decompressor.error().empty() && !_fail )
+      {
+         *_err << "Error while decompressing input: " << _decompressor.error() << std::endl;
+         _fail = true;
+      }
+   }
+   else if( _read )
+      n = _read(_buffer.data() + remaining, _buffer.size() - remaining);
+   else
+      n = std::fread(_buffer.data() + remaining, 1, _buffer.size() - remaining, _file);
+
+   _begin = _cur = _buffer.data();
+   _end = _begin + remaining + n;
+
+   return n > 0;
+}
+
+
+inline bool Tokenizer::_skipSpace()
+{
+   while( true )
+   {
+      while( _cur < _end && _isSpace(*_cur) )
+         ++_cur;
+
+      if( _cur < _end )
+         return true;
+
+      if( !_refill() )
+      {
+         _eof = true;
+         return false;
+      }
+   }
+}
+
+
+inline bool Tokenizer::atEnd()
+{
+   if( _binary )
+      return peek() == EOF;
+
+   return !_skipSpace();
+}
+
+
+inline bool Tokenizer::nextToken(TokenView &token)
+{
+   if( _binary )
+   {
+      if( !_nextBinary() )
+         return false;
+
+      _binaryText(token);
+      return true;
+   }
+
+   if( _fail || !_skipSpace() )
+   {
+      _fail = true;
+      return false;
+   }
+
+   const char* start = _cur;
+
+   while( true )
+   {
+      while( _cur < _end && !_isSpace(*_cur) )
+         ++_cur;
+
+      if( _cur < _end )
+         break;
+
+      // token may continue in the next block
+      size_t length = _cur - start;
+      _cur = start;
+      bool more = _refill();
+      start = _cur;
+      _cur += length;
+
+      if( !more )
+      {
+         _eof = true;
+         break;
+      }
+   }
+
+   token.data = start;
+   token.size = _cur - start;
+
+   return true;
+}
+
+
+inline Tokenizer& Tokenizer::operator>>(std::string &value)
+{
+   TokenView token;
+
+   if( nextToken(token) )
+      value.assign(token.data, token.size);
+
+   return *this;
+}
+
+
+inline Tokenizer& Tokenizer::operator>>(char &value)
+{
+   TokenView token;
+
+   // binary tokens cannot be split, so only single characters can be read
+   if( _binary )
+   {
+      if( nextToken(token) )
+      {
+         if( token.size == 1 )
+            value = token.data[0];
+         else
+            _fail = true;
+      }
+   }
+   else if( _fail || !_skipSpace() )
+      _fail = true;
+   else
+      value = *_cur++;
+
+   return *this;
+}
+
+
+// like std::istream, a number directly followed by other characters, e.g. "-1}" at the end of a
+// derivation, ends before them, which are left for the next extraction; returns false if the
+// token does not start with a number
+inline bool Tokenizer::_truncateToNumber(TokenView &token, bool fraction)
+{
+   const char* c = token.data;
+   const char* end = token.data + token.size;
+
+   if( c < end && (*c == '-' || *c == '+') )
+      ++c;
+
+   const char* digits = c;
+   while( c < end && *c >= '0' && *c <= '9' )
+      ++c;
+
+   if( c == digits )
+      return false;
+
+   if( fraction && c + 1 < end && *c == '/' && c[1] >= '0' && c[1] <= '9' )
+   {
+      for( c += 2; c < end && *c >= '0' && *c <= '9'; ++c )
+         ;
+   }
+
+   if( c == end )
+      return false;
+
+   // the token is still buffered up to _cur, and input remains even if it ended the file
+   _cur -= end - c;
+   token.size = c - token.data;
+   _eof = false;
+
+   return true;
+}
+
+
+template <typename T>
+inline bool Tokenizer::_parseSigned(const char* data, size_t size, T &value)
+{
+   const char* c = data;
+   const char* end = data + size;
+   bool negative = (*c == '-');
+   unsigned long long limit = negative ? (unsigned long long) std::numeric_limits<T>::max() + 1
+                                       : (unsigned long long) std::numeric_limits<T>::max();
+   unsigned long long result = 0;
+
+   if( *c == '-' || *c == '+' )
+      ++c;
+
+   if( c == end )
+      return false;
+
+   for( ; c < end; ++c )
+   {
+      unsigned digit = (unsigned) (*c - '0');
+
+      if( digit > 9 || result > (limit - digit) / 10 )
+         return false;
+
+      result = 10 * result + digit;
+   }
+
+   value = negative ? (T) (0 - result) : (T) result;
+
+   return true;
+}
+
+
+template <typename T>
+inline bool Tokenizer::_parseUnsigned(const char* data, size_t size, T &value)
+{
+   const char* c = data;
+   const char* end = data + size;
+   unsigned long long limit = std::numeric_limits<T>::max();
+   unsigned long long result = 0;
+
+   if( *c == '+' )
+      ++c;
+
+   if( c == end )
+      return false;
+
+   for( ; c < end; ++c )
+   {
+      unsigned digit = (unsigned) (*c - '0');
+
+      if( digit > 9 || result > (limit - digit) / 10 )
+         return false;
+
+      result = 10 * result + digit;
+   }
+
+   value = (T) result;
+
+   return true;
+}
+
+
+template <typename T>
+inline Tokenizer& Tokenizer::_readSigned(T &value)
+{
+   TokenView token;
+   bool success;
+
+   if( !_binary )
+      success = nextToken(token) && (_parseSigned(token.data, token.size, value)
+         || (_truncateToNumber(token, false) && _parseSigned(token.data, token.size, value)));
+   else if( !_nextBinary() )
+      success = false;
+   else if( _tag == BINARY_INT )
+   {
+      success = (_intValue >= (long long) std::numeric_limits<T>::min() && _intValue <= (long long) std::numeric_limits<T>::max());
+      value = (T) _intValue;
+   }
+   else
+      success = (_tag == BINARY_STRING && _parseSigned(_stringData, _stringSize, value));
+
+   // like std::istream, a failed extraction stores 0
+   if( !success )
+   {
+      value = 0;
+      _fail = true;
+   }
+
+   return *this;
+}
+
+
+template <typename T>
+inline Tokenizer& Tokenizer::_readUnsigned(T &value)
+{
+   TokenView token;
+   bool success;
+
+   if( !_binary )
+      success = nextToken(token) && (_parseUnsigned(token.data, token.size, value)
+         || (_truncateToNumber(token, false) && _parseUnsigned(token.data, token.size, value)));
+   else if( !_nextBinary() )
+      success = false;
+   else if( _tag == BINARY_INT )
+   {
+      success = (_intValue >= 0 && (unsigned long long) _intValue <= (unsigned long long) std::numeric_limits<T>::max());
+      value = (T) _intValue;
+   }
+   else
+      success = (_tag == BINARY_STRING && _parseUnsigned(_stringData, _stringSize, value));
+
+   if( !success )
+   {
+      value = 0;
+      _fail = true;
+   }
+
+   return *this;
+}
+
+
+// sets a GMP integer from a 64-bit integer also where long has 32 bits
+inline void setInt64(mpz_ptr value, long long v)
+{
+   if( v >= LONG_MIN && v <= LONG_MAX )
+      mpz_set_si(value, (long) v);
+   else
+   {
+      unsigned long long magnitude = (v < 0) ? 0 - (unsigned long long) v : (unsigned long long) v;
+
+      mpz_import(value, 1, -1, sizeof(magnitude), 0, 0, &magnitude);
+      if( v < 0 )
+         mpz_neg(value, value);
+   }
+}
+
+
+// numbers with at most 18 digits are set from 64-bit integers, longer ones through mpq_set_str
+inline bool Tokenizer::parseRational(const char* data, size_t size, mpq_class &value, std::string &scratch)
+{
+   const char* c = data;
+   const char* end = data + size;
+   const char* slash = static_cast<const char*>(memchr(data, '/', size));
+   const char* numEnd = (slash != nullptr) ? slash : end;
+   bool negative = (*c == '-');
+
+   if( *c == '-' || *c == '+' )
+      ++c;
+
+   size_t numDigits = numEnd - c;
+   size_t denDigits = (slash != nullptr) ? end - slash - 1 : 1;
+
+   if( numDigits == 0 || denDigits == 0 )
+      return false;
+
+   if( numDigits <= 18 && denDigits <= 18 )
+   {
+      long long num = 0;
+      long long den = 1;
+
+      for( ; c < numEnd; ++c )
+      {
+         if( *c < '0' || *c > '9' )
+            return false;
+         num = 10 * num + (*c - '0');
+      }
+
+      if( slash != nullptr )
+      {
+         den = 0;
+         for( c = slash + 1; c < end; ++c )
+         {
+            if( *c < '0' || *c > '9' )
+               return false;
+            den = 10 * den + (*c - '0');
+         }
+
+         if( den == 0 )
+            return false;
+      }
+
+      // long has only 32 bits on Windows
+      if( num <= LONG_MAX && den <= LONG_MAX )
+         mpq_set_si(value.get_mpq_t(), negative ? -(long) num : (long) num, (unsigned long) den);
+      else
+      {
+         setInt64(value.get_num_mpz_t(), negative ? -num : num);
+         setInt64(value.get_den_mpz_t(), den);
+      }
+      if( den != 1 )
+         value.canonicalize();
+
+      return true;
+   }
+
+   // GMP needs a null-terminated string and accepts no leading '+'
+   if( *data == '+' )
+      scratch.assign(data + 1, size - 1);
+   else
+      scratch.assign(data, size);
+
+   if( mpq_set_str(value.get_mpq_t(), scratch.c_str(), 10) != 0 || sgn(value.get_den()) == 0 )
+      return false;
+
+   value.canonicalize();
+
+   return true;
+}
+
+
+inline Tokenizer& Tokenizer::operator>>(mpq_class &value)
+{
+   TokenView token;
+
+   if( !_binary )
+   {
+      if( nextToken(token) && !parseRational(token.data, token.size, value, _scratch)
+         && !(_truncateToNumber(token, true) && parseRational(token.data, token.size, value, _scratch)) )
+         _fail = true;
+   }
+   else if( _nextBinary() )
+   {
+      switch( _tag )
+      {
+         case BINARY_INT:
+            setInt64(value.get_num_mpz_t(), _intValue);
+            mpz_set_ui(value.get_den_mpz_t(), 1);
+            break;
+         case BINARY_RATIONAL:
+            setInt64(value.get_num_mpz_t(), _intValue);
+            setInt64(value.get_den_mpz_t(), (long long) _denValue);
+            value.canonicalize();
+            break;
+         case BINARY_BIGRATIONAL:
+            mpq_swap(value.get_mpq_t(), _bigValue.get_mpq_t());
+            value.canonicalize();
+            break;
+         default:
+            if( !parseRational(_stringData, _stringSize, value, _scratch) )
+               _fail = true;
+      }
+   }
+
+   return *this;
+}
+
+
+template <typename T>
+inline Tokenizer& Tokenizer::operator>>(T &value)
+{
+   TokenView token;
+
+   if( nextToken(token) )
+   {
+      _stream.clear();
+      _stream.str(token.str());
+      _stream >> value;
+
+      if( _stream.fail() )
+         _fail = true;
+   }
+
+   return *this;
+}
+
+
+// for binary input '\n' at a line break and ' ' before any other token
+inline int Tokenizer::peek()
+{
+   if( _cur == _end && !_refill() )
+   {
+      _eof = true;
+      return EOF;
+   }
+
+   if( _binary )
+   {
+      if( (unsigned char) *_cur == BINARY_NEWLINE )
+         return '\n';
+      if( (unsigned char) *_cur == BINARY_END )
+      {
+         _eof = true;
+         return EOF;
+      }
+      return ' ';
+   }
+
+   return (unsigned char) *_cur;
+}
+
+
+// steps back over the last character read, which has to be c
+inline Tokenizer& Tokenizer::putback(char c)
+{
+   if( _binary )
+   {
+      if( _tag == BINARY_STRING && _stringSize == 1 && _stringData[0] == c )
+         seekg(_tokenPos);
+      else
+         _fail = true;
+   }
+   else if( _cur > _begin && _cur[-1] == c )
+   {
+      --_cur;
+      _eof = false;
+   }
+   else
+      _fail = true;
+
+   return *this;
+}
+
+
+// for binary input, every token and line break counts as one character
+inline Tokenizer& Tokenizer::ignore(std::streamsize n, int delim)
+{
+   if( _binary )
+   {
+      for( std::streamsize i = 0; n == std::numeric_limits<std::streamsize>::max() || i < n; ++i )
+      {
+         int next = peek();
+
+         if( next == EOF )
+            break;
+         else if( next == '\n' )
+         {
+            ++_cur;
+            if( delim == '\n' )
+               break;
+         }
+         else if( !_nextBinary() )
+            break;
+      }
+
+      return *this;
+   }
+
+   for( std::streamsize i = 0; n == std::numeric_limits<std::streamsize>::max() || i < n; ++i )
+   {
+      if( _cur == _end && !_refill() )
+      {
+         _eof = true;
+         break;
+      }
+
+      if( (unsigned char) *_cur++ == delim )
+         break;
+   }
+
+   return *this;
+}
+
+
+// for binary input, the tokens up to the next line break separated by spaces
+inline Tokenizer& Tokenizer::getline(std::string &line)
+{
+   line.clear();
+
+   if( _fail )
+      return *this;
+
+   if( _binary )
+   {
+      TokenView token;
+      bool empty = true;
+
+      while( true )
+      {
+         int next = peek();
+
+         if( next == '\n' )
+         {
+            ++_cur;
+            return *this;
+         }
+         if( next == EOF || !nextToken(token) )
+         {
+            _eof = true;
+            _fail = empty;
+            return *this;
+         }
+
+         if( !empty )
+            line += ' ';
+         line.append(token.data, token.size);
+         empty = false;
+      }
+   }
+
+   while( true )
+   {
+      const char* newline = static_cast<const char*>(memchr(_cur, '\n', _end - _cur));
+
+      if( newline != nullptr )
+      {
+         line.append(_cur, newline - _cur);
+         _cur = newline + 1;
+         return *this;
+      }
+
+      line.append(_cur, _end - _cur);
+      _cur = _end;
+
+      if( !_refill() )
+      {
+         _eof = true;
+         if( line.empty() )
+            _fail = true;
+         return *this;
+      }
+   }
+}
+
+
+inline Tokenizer& Tokenizer::getline(char* line, std::streamsize n)
+{
+   std::string tmp;
+
+   getline(tmp);
+
+   if( (std::streamsize) tmp.size() >= n )
+   {
+      tmp.resize(n - 1);
+      _fail = true;
+   }
+
+   memcpy(line, tmp.c_str(), tmp.size() + 1);
+
+   return *this;
+}
+
+
+inline Tokenizer& Tokenizer::seekg(std::streampos pos)
+{
+   size_t target = (size_t) (std::streamoff) pos;
+
+   if( _mapped != nullptr && _compression == Compression::NONE )
+   {
+      if( target > _mappedSize )
+         _fail = true;
+      else
+         _cur = _begin + target;
+   }
+   else if( target >= _offset && target <= _offset + (_end - _begin) )
+      _cur = _begin + (target - _offset);
+   else if( _compression != Compression::NONE )
+   {
+      // compressed input can only be read forward, so seeking back starts over
+      if( target < _offset )
+      {
+         _decompressor.stop();
+
+         if( _mapped != nullptr )
+            _startDecompression(_compression, static_cast<const char*>(_mapped), _mappedSize);
+         else if( std::fseek(_file, 0, SEEK_SET) == 0 )
+            _startDecompression(_compression, nullptr, 0);
+         else
+            _fail = true;
+      }
+
+      while( !_fail && target > _offset + (_end - _begin) )
+      {
+         _cur = _end;
+         if( !_refill() )
+            _fail = true;
+      }
+
+      if( !_fail )
+         _cur = _begin + (target - _offset);
+   }
+   else if( _file != nullptr && std::fseek(_file, (long) target, SEEK_SET) == 0 )
+   {
+      _offset = target;
+      _begin = _cur = _end = _buffer.data();
+   }
+   else
+      _fail = true;
+
+   if( !_fail )
+      _eof = false;
+
+   return *this;
+}
+
+inline Tokenizer& Tokenizer::copyTo(std::ostream &out, std::streamsize n)
+{
+   while( n > 0 )
+   {
+      if( _cur == _end && !_refill() )
+      {
+         _eof = true;
+         _fail = true;
+         break;
+      }
+
+      std::streamsize chunk = std::min(n, (std::streamsize) (_end - _cur));
+      out.write(_cur, chunk);
+      _cur += chunk;
+      n -= chunk;
+   }
+
+   return *this;
+}
+
+
+// skips the header of a binary certificate
+inline bool Tokenizer::_detectBinary()
+{
+   while( _end - _cur < (std::ptrdiff_t) sizeof(binaryMagic) + 1 )
+   {
+      if( !_refill() )
+         return false;
+   }
+
+   if( memcmp(_cur, binaryMagic, sizeof(binaryMagic)) != 0 )
+      return false;
+
+   if( (unsigned char) _cur[sizeof(binaryMagic)] != binaryVersion )
+   {
+      *_err << "Unsupported version " << (int) (unsigned char) _cur[sizeof(binaryMagic)]
+           << " of the binary certificate format" << std::endl;
+      _fail = true;
+      return false;
+   }
+
+   _cur += sizeof(binaryMagic) + 1;
+   _binary = true;
+
+   return true;
+}
+
+
+inline bool Tokenizer::_readVarint(unsigned long long &value)
+{
+   value = 0;
+
+   for( int shift = 0; shift < 64; shift += 7 )
+   {
+      if( _cur == _end && !_refill() )
+         return false;
+
+      unsigned char byte = (unsigned char) *_cur++;
+
+      value |= (unsigned long long) (byte & 0x7f) << shift;
+
+      if( byte < 0x80 )
+         return true;
+   }
+
+   return false;
+}
+
+
+// reads 64-bit little-endian words into value
+inline bool Tokenizer::_readWords(mpz_ptr value, size_t words)
+{
+   size_t size = 8 * words;
+
+   while( (size_t) (_end - _cur) < size )
+   {
+      if( !_refill() )
+         return false;
+   }
+
+   mpz_import(value, words, -1, 8, -1, 0, _cur);
+   _cur += size;
+
+   return true;
+}
+
+
+// reads the next token of a binary certificate, skipping line breaks
+inline bool Tokenizer::_nextBinary()
+{
+   unsigned long long value;
+   unsigned long long words;
+
+   if( _fail )
+      return false;
+
+   while( true )
+   {
+      if( _cur == _end && !_refill() )
+      {
+         _eof = true;
+         _fail = true;
+         return false;
+      }
+
+      _tokenPos = _offset + (_cur - _begin);
+      _tag = (unsigned char) *_cur++;
+
+      switch( _tag )
+      {
+         case BINARY_NEWLINE:
+            continue;
+         case BINARY_END:
+            --_cur;
+            _eof = true;
+            _fail = true;
+            return false;
+         case BINARY_STRING:
+            if( !_readVarint(value) )
+               break;
+            while( (unsigned long long) (_end - _cur) < value && _refill() )
+               ;
+            if( (unsigned long long) (_end - _cur) < value )
+               break;
+            _stringData = _cur;
+            _stringSize = (size_t) value;
+            _cur += value;
+            return true;
+         case BINARY_INT:
+            if( !_readVarint(value) )
+               break;
+            _intValue = (long long) (value >> 1) ^ -(long long) (value & 1);
+            return true;
+         case BINARY_RATIONAL:
+            if( !_readVarint(value) || !_readVarint(_denValue) || _denValue == 0 || _denValue > LLONG_MAX )
+               break;
+            _intValue = (long long) (value >> 1) ^ -(long long) (value & 1);
+            return true;
+         case BINARY_BIGRATIONAL:
+            if( !_readVarint(words) || !_readWords(_bigValue.get_num_mpz_t(), words >> 1) )
+               break;
+            if( words & 1 )
+               mpz_neg(_bigValue.get_num_mpz_t(), _bigValue.get_num_mpz_t());
+            if( !_readVarint(words) )
+               break;
+            if( words == 0 )
+               mpz_set_ui(_bigValue.get_den_mpz_t(), 1);
+            else if( !_readWords(_bigValue.get_den_mpz_t(), words) || sgn(_bigValue.get_den()) == 0 )
+               break;
+            return true;
+         default:
+            break;
+      }
+
+      *_err << "Corrupt binary certificate at position " << _tokenPos << std::endl;
+      _fail = true;
+      return false;
+   }
+}
+
+
+// text of the last binary token
+inline void Tokenizer::_binaryText(TokenView &token)
+{
+   switch( _tag )
+   {
+      case BINARY_STRING:
+         token.data = _stringData;
+         token.size = _stringSize;
+         return;
+      case BINARY_INT:
+         token.size = (size_t) snprintf(_number, sizeof(_number), "%lld", _intValue);
+         break;
+      case BINARY_RATIONAL:
+         token.size = (size_t) snprintf(_number, sizeof(_number), "%lld/%llu", _intValue, _denValue);
+         break;
+      default:
+         _scratch = _bigValue.get_str();
+         token.data = _scratch.data();
+         token.size = _scratch.size();
+         return;
+   }
+
+   token.data = _number;
+}
+
+
+inline bool Tokenizer::readDerivationOffsets(std::vector<size_t> &offsets)
+{
+   offsets.clear();
+
+   if( !_binary || _mapped == nullptr || _compression != Compression::NONE || _mappedSize < binaryFooterSize )
+      return false;
+
+   const unsigned char* data = static_cast<const unsigned char*>(_mapped);
+   const unsigned char* footer = data + _mappedSize - binaryFooterSize;
+   unsigned long long tablePos = 0;
+
+   if( memcmp(footer + 8, binaryMagic, sizeof(binaryMagic)) != 0 )
+      return false;
+
+   for( int i = 7; i >= 0; --i )
+      tablePos = (tablePos << 8) | footer[i];
+
+   if( tablePos >= _mappedSize - binaryFooterSize )
+      return false;
+
+   // number of derivations, then the differences of consecutive offsets
+   const unsigned char* c = data + tablePos;
+   unsigned long long count = 0;
+   unsigned long long offset = 0;
+
+   for( unsigned long long k = 0; k <= count; ++k )
+   {
+      unsigned long long value = 0;
+
+      for( int shift = 0; ; shift += 7 )
+      {
+         if( c >= footer || shift >= 64 )
+            return false;
+
+         value |= (unsigned long long) (*c & 0x7f) << shift;
+
+         if( *c++ < 0x80 )
+            break;
+      }
+
+      if( k == 0 )
+      {
+         count = value;
+         offsets.reserve((size_t) std::min(count, (unsigned long long) (footer - c)));
+      }
+      else
+      {
+         offset += value;
+         offsets.push_back((size_t) offset);
+      }
+   }
+
+   return true;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+*
+*   Copyright (c) 2016 Kevin K. H. Cheung
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// In-process interface of the VIPR checker
+//
+// The checks of viprchk are available as a library (libvipr), so a solver or a test
+// harness can check certificates without writing them to a file and starting a
+// process. Every call keeps its state in its own object; several certificates can be
+// checked at once from different threads, as long as each uses its own streams.
+//
+// The result is the same as the exit status of viprchk: true iff the certificate was
+// read completely and every statement in it was verified.
+
+#ifndef VIPR_HPP
+#define VIPR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include "stats.hpp"
+
+namespace vipr
+{
+
+// delivers the next bytes of a certificate into buffer, returns their number and 0 at the end
+typedef std::function<size_t(char* buffer, size_t size)> ReadCallback;
+
+class Checker
+{
+   public:
+      // progress and results are written to out, errors to err
+      Checker(std::ostream &out = std::cout, std::ostream &err = std::cerr);
+
+      // checks the certificate in the file; gzip, zstd and binary files are recognized
+      bool checkFile(const char* filename);
+
+      // checks the certificate held in memory, the data has to stay valid during the check
+      bool checkBuffer(const char* data, size_t size);
+
+      // checks the certificate delivered by read; compressed input is not supported here
+      bool checkStream(const ReadCallback &read);
+
+      // seconds between progress lines during the DER section, 0 (the default) for none
+      void setProgressInterval(double seconds);
+
+      // phase times, counters and peak memory of the last check
+      Stats& stats() { return _stats; }
+
+   private:
+      std::ostream &_out;
+      std::ostream &_err;
+      Stats _stats;
+      double _progressInterval = 0.0;
+};
+
+} // namespace vipr
+
+#endif
@@ -0,0 +1,355 @@
+/*
+*
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Converts a .vipr certificate into the binary format described in cert_spec_binary.md
+
+#include <cctype>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+
+// Timing
+#include <sys/time.h>
+
+using namespace std;
+
+
+// Writes the tokens of a certificate in binary form and records where derivations start
+class BinaryWriter
+{
+   public:
+      BinaryWriter(ostream &out) : _out(out) {}
+
+      void writeHeader();
+      void writeToken(const char* data, size_t size);
+      void writeNewline() { _put(BINARY_NEWLINE); }
+
+      // the next token starts a derivation
+      void markDerivation() { _offsets.push_back(_pos); }
+      size_t numberOfDerivations() const { return _offsets.size(); }
+
+      // writes the end tag, the derivation offset table and the footer
+      void finish();
+
+   private:
+      ostream &_out;
+      size_t _pos = 0; // bytes written
+      vector<size_t> _offsets;
+      mpq_class _value;
+      string _scratch;
+      vector<unsigned char> _words;
+
+      void _put(unsigned char byte) { _out.put((char) byte); ++_pos; }
+      void _write(const void* data, size_t size) { _out.write(static_cast<const char*>(data), size); _pos += size; }
+      void _putVarint(unsigned long long value);
+      void _putWords(mpz_srcptr value, bool withSign);
+      static unsigned long long _zigzag(long long value) { return ((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63); }
+      static long long _toInt64(mpz_srcptr value);
+      static bool _isRationalText(const char* data, size_t size);
+};
+
+
+void BinaryWriter::writeHeader()
+{
+   _write(binaryMagic, sizeof(binaryMagic));
+   _put(binaryVersion);
+}
+
+
+void BinaryWriter::_putVarint(unsigned long long value)
+{
+   while( value >= 0x80 )
+   {
+      _put((unsigned char) (value | 0x80));
+      value >>= 7;
+   }
+   _put((unsigned char) value);
+}
+
+
+// number of 64-bit words (times two plus sign) followed by the words, least significant first
+void BinaryWriter::_putWords(mpz_srcptr value, bool withSign)
+{
+   size_t words = (mpz_sizeinbase(value, 2) + 63) / 64;
+
+   if( mpz_sgn(value) == 0 )
+      words = 0;
+
+   _words.assign(8 * words + 8, 0);
+   mpz_export(_words.data(), &words, -1, 8, -1, 0, value);
+
+   if( withSign )
+      _putVarint(2 * words + (mpz_sgn(value) < 0 ? 1 : 0));
+   else
+      _putVarint(words);
+
+   _write(_words.data(), 8 * words);
+}
+
+
+// value has to fit into 63 bits; also works where long has 32 bits
+long long BinaryWriter::_toInt64(mpz_srcptr value)
+{
+   unsigned long long magnitude = 0;
+
+   mpz_export(&magnitude, nullptr, -1, sizeof(magnitude), 0, 0, value);
+
+   return mpz_sgn(value) < 0 ? -(long long) magnitude : (long long) magnitude;
+}
+
+
+// only digits, a leading minus and a slash, so that at most the canonical form has to be checked
+bool BinaryWriter::_isRationalText(const char* data, size_t size)
+{
+   for( size_t i = 0; i < size; ++i )
+   {
+      if( !((data[i] >= '0' && data[i] <= '9') || data[i] == '/' || (i == 0 && data[i] == '-')) )
+         return false;
+   }
+
+   return size > 0;
+}
+
+
+// numbers are stored as such only if they are written in canonical form, so that
+// converting back reproduces the text; everything else is stored as a string
+void BinaryWriter::writeToken(const char* data, size_t size)
+{
+   if( _isRationalText(data, size) && Tokenizer::parseRational(data, size, _value, _scratch) )
+   {
+      _scratch = _value.get_str();
+
+      if( _scratch.size() == size && memcmp(_scratch.data(), data, size) == 0 )
+      {
+         size_t numBits = mpz_sizeinbase(_value.get_num_mpz_t(), 2);
+         size_t denBits = mpz_sizeinbase(_value.get_den_mpz_t(), 2);
+
+         if( numBits <= 62 && denBits == 1 )
+         {
+            _put(BINARY_INT);
+            _putVarint(_zigzag(_toInt64(_value.get_num_mpz_t())));
+         }
+         else if( numBits <= 62 && denBits <= 62 )
+         {
+            _put(BINARY_RATIONAL);
+            _putVarint(_zigzag(_toInt64(_value.get_num_mpz_t())));
+            _putVarint((unsigned long long) _toInt64(_value.get_den_mpz_t()));
+         }
+         else
+         {
+            _put(BINARY_BIGRATIONAL);
+            _putWords(_value.get_num_mpz_t(), true);
+            if( denBits == 1 )
+               _putVarint(0);
+            else
+               _putWords(_value.get_den_mpz_t(), false);
+         }
+
+         return;
+      }
+   }
+
+   _put(BINARY_STRING);
+   _putVarint(size);
+   _write(data, size);
+}
+
+
+void BinaryWriter::finish()
+{
+   _put(BINARY_END);
+
+   size_t tablePos = _pos;
+   size_t last = 0;
+
+   _putVarint(_offsets.size());
+   for( auto offset : _offsets )
+   {
+      _putVarint(offset - last);
+      last = offset;
+   }
+
+   unsigned char footer[8];
+   for( int i = 0; i < 8; ++i )
+      footer[i] = (unsigned char) ((unsigned long long) tablePos >> (8 * i));
+
+   _write(footer, sizeof(footer));
+   _write(binaryMagic, sizeof(binaryMagic));
+}
+
+
+static double getTimeSecs(timeval start, timeval end)
+{
+   return (end.tv_sec + end.tv_usec / 1000000.0) - (start.tv_sec + start.tv_usec / 1000000.0);
+}
+
+
+int main(int argc, char *argv[])
+{
+   int rs = -1;
+   Tokenizer certificateFile;
+   ofstream binaryFile;
+   string binaryFileName;
+   string line;
+   timeval start, end;
+
+   // position in the certificate, to find the start of every derivation
+   enum { BEFORE_DER, DER_COUNT, DER_START, IN_DERIVATION, MAX_REF_IDX } state = BEFORE_DER;
+   int depth = 0;
+   size_t numberOfDerivations = 0;
+
+   if( argc != 2 && argc != 3 )
+   {
+      cerr << "Usage: " << argv[0] << " <certificateFile> [<binaryFile>]\n";
+      return rs;
+   }
+
+   gettimeofday(&start, 0);
+
+   certificateFile.open(argv[1]);
+
+   if( certificateFile.fail() )
+   {
+      cerr << "Failed to open file " << argv[1] << endl;
+      return rs;
+   }
+
+   if( certificateFile.isBinary() )
+   {
+      cerr << argv[1] << " is already a binary certificate" << endl;
+      return rs;
+   }
+
+   if( argc == 3 )
+      binaryFileName = argv[2];
+   else
+   {
+      binaryFileName = stripCompressionSuffix(argv[1]);
+      if( binaryFileName.size() > 5 && binaryFileName.compare(binaryFileName.size() - 5, 5, ".vipr") == 0 )
+         binaryFileName.resize(binaryFileName.size() - 5);
+      binaryFileName += ".vipb";
+   }
+
+   binaryFile.open(binaryFileName.c_str(), ios::out | ios::binary);
+
+   if( binaryFile.fail() )
+   {
+      cerr << "Failed to open file " << binaryFileName << endl;
+      return rs;
+   }
+
+   {
+      BinaryWriter writer(binaryFile);
+
+      writer.writeHeader();
+
+      while( getline(certificateFile, line) )
+      {
+         const char* c = line.c_str();
+         const char* lineEnd = c + line.size();
+         bool isComment = false;
+         bool isFirst = true;
+
+         while( true )
+         {
+            while( c < lineEnd && isspace((unsigned char) *c) )
+               ++c;
+
+            if( c == lineEnd )
+               break;
+
+            const char* tokenStart = c;
+
+            while( c < lineEnd && !isspace((unsigned char) *c) )
+               ++c;
+
+            size_t size = c - tokenStart;
+
+            if( isFirst && *tokenStart == '%' )
+               isComment = true;
+
+            if( !isComment )
+            {
+               switch( state )
+               {
+                  case BEFORE_DER:
+                     if( isFirst && size == 3 && memcmp(tokenStart, "DER", 3) == 0 )
+                        state = DER_COUNT;
+                     break;
+                  case DER_COUNT:
+                     state = DER_START;
+                     break;
+                  case DER_START:
+                     writer.markDerivation();
+                     state = IN_DERIVATION;
+                     depth = 0;
+                     break;
+                  case IN_DERIVATION:
+                     if( size == 1 && *tokenStart == '{' )
+                        ++depth;
+                     else if( size == 1 && *tokenStart == '}' && --depth == 0 )
+                        state = MAX_REF_IDX;
+                     break;
+                  case MAX_REF_IDX:
+                     state = DER_START;
+                     break;
+               }
+            }
+
+            writer.writeToken(tokenStart, size);
+            isFirst = false;
+         }
+
+         writer.writeNewline();
+      }
+
+      numberOfDerivations = writer.numberOfDerivations();
+      writer.finish();
+   }
+
+   binaryFile.close();
+
+   if( binaryFile.fail() )
+   {
+      cerr << "Failed to write file " << binaryFileName << endl;
+      return rs;
+   }
+
+   if( certificateFile.fail() && !certificateFile.eof() )
+   {
+      cerr << "Failed to read file " << argv[1] << endl;
+      return rs;
+   }
+
+   gettimeofday(&end, 0);
+
+   cout << "Wrote " << binaryFileName << " with " << numberOfDerivations << " derivations in "
+        << getTimeSecs(start, end) << " seconds (Wall Clock)" << endl;
+
+   rs = 0;
+
+   return rs;
+}
@@ -23,48 +23,192 @@
 *
 */
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
 
 using namespace std;
 
-ifstream pf;
-ofstream html;
+Tokenizer pf;
+ofstream htmlFile;
+ostream html(nullptr); // writes to htmlFile, or discards the output of derivations that are not shown
+vector<char> htmlBuffer(1 << 22);
 vector<string> colName;
 vector<string> rowName;
 vector<bool> isInt; // boolean indicators for integer variable indices
 
+// Set usage options
+static void printUsage(const char* const argv[])
+{
+   cerr << "Usage: " << argv[0] << " [options] filename\n"
+        << "  --pagesize=<number>   write at most this many derivations per page; further pages are\n"
+        << "                        written to filename_<page>.html and linked from the previous page\n"
+        << "  --label=<label>       only show the derivations that the constraint with this label depends on\n";
+}
+
+// opens the html file of a page and writes the header
+static bool openPage( const string &fname )
+{
+   htmlFile.rdbuf()->pubsetbuf( htmlBuffer.data(), htmlBuffer.size() );
+   htmlFile.open( fname.c_str() );
+
+   if( htmlFile.fail() )
+   {
+      cerr << "Failed to open file " << fname << endl;
+      return false;
+   }
+
+   html.rdbuf( htmlFile.rdbuf() );
+   html.clear();
+
+   html << "<HTML>" << '\n';
+   html << "<HEAD>" << '\n';
+   html << "<STYLE>" << '\n';
+   html << "TABLE, TH, TD {" << '\n';
+   html << "   border-collapse: collapse;" << '\n';
+   html << "   border: 1px solid black;" << '\n';
+   html << "}" << '\n';
+   html << "</STYLE>" << '\n';
+   html << "</HEAD>" << '\n';
+   html << "<BODY>" << '\n';
+
+   return true;
+}
+
+// writes the footer and closes the html file of a page
+static void closePage()
+{
+   html.rdbuf( htmlFile.rdbuf() );
+   html.clear();
+   html << "</BODY>" << '\n';
+   html << "</HTML>" << '\n';
+   htmlFile.close();
+}
+
+// file name of a page of derivations, the first page is the main file
+static string pageName( const string &base, int page )
+{
+   return ( page == 1 ) ? base + ".html" : base + "_" + to_string( page ) + ".html";
+}
+
+// file name without the directory, for links between pages
+static string linkName( const string &fname )
+{
+   size_t pos = fname.find_last_of( '/' );
+   return ( pos == string::npos ) ? fname : fname.substr( pos + 1 );
+}
+
+// reads the next derivation and adds the derivations it references to needs
+static bool scanDependencies( int numCon, string &label, vector<int> &needs )
+{
+   string sense, tmp, val;
+   int k;
+
+   auto _addNeed = [ &needs, &numCon ]( int index )
+   {
+      if( index >= numCon ) needs.push_back( index - numCon );
+   };
+
+   pf >> label >> sense >> tmp >> tmp;
+   if( tmp != "OBJ" )
+   {
+      k = atoi( tmp.c_str() );
+      for( int i = 0; i < 2 * k; ++i ) pf >> tmp;
+   }
+
+   pf >> tmp;
+   if( pf.fail() || tmp != "{" ) return false;
+
+   pf >> tmp;
+   if( tmp == "lin" || tmp == "rnd" )
+   {
+      pf >> tmp;
+      if( tmp == "incomplete" )
+      {
+         for( pf >> tmp; !pf.fail() && tmp != "}"; pf >> tmp )
+            _addNeed( atoi( tmp.c_str() ) );
+         pf >> tmp; // max reference index
+         return !pf.fail();
+      }
+      else if( tmp == "weak" )
+      {
+         while( pf >> tmp && tmp != "}" );
+         pf >> tmp;
+      }
+
+      k = atoi( tmp.c_str() );
+      for( int i = 0; i < k; ++i )
+      {
+         pf >> tmp >> val;
+         _addNeed( atoi( tmp.c_str() ) );
+      }
+   }
+   else if( tmp == "uns" )
+   {
+      for( int i = 0; i < 4; ++i )
+      {
+         pf >> tmp;
+         _addNeed( atoi( tmp.c_str() ) );
+      }
+   }
+   else if( tmp != "asm" && tmp != "sol" )
+      return false;
+
+   pf >> tmp; // }
+   pf >> tmp; // max reference index
+
+   return !pf.fail();
+}
 
 
 int main(int argc, char *argv[])
 {
    int rs = -1;
+   int pageSize = 0; // derivations per page, all on one page if 0
+   string targetLabel; // only show the derivations this constraint depends on
+   const char* fname = nullptr;
 
-   if( argc != 2 )
+   for( int i = 1; i < argc; ++i )
    {
-      cerr << "Usage: " << argv[0] << " filename\n";
+      if( strncmp( argv[i], "--pagesize=", 11 ) == 0 && atoi( &argv[i][11] ) > 0 )
+         pageSize = atoi( &argv[i][11] );
+      else if( strncmp( argv[i], "--label=", 8 ) == 0 && argv[i][8] != '\0' )
+         targetLabel = &argv[i][8];
+      else if( argv[i][0] != '-' && fname == nullptr )
+         fname = argv[i];
+      else
+      {
+         printUsage( argv );
+         return rs;
+      }
+   }
+
+   if( fname == nullptr )
+   {
+      printUsage( argv );
       return rs;
    }
 
-   pf.open( argv[1] );
+   pf.open( fname );
 
    if( pf.fail() )
    {
-      cerr << "Failed to open file " << argv[1] << endl;
+      cerr << "Failed to open file " << fname << endl;
       return rs;
    }
 
-   string htmlFname = string(argv[1]) + ".html";
-
-   html.open( htmlFname.c_str());
-
-   if ( html.fail() )
+   if( pf.isBinary() )
    {
-      cerr << "Failed to open file " << htmlFname << endl;
+      cerr << "Binary certificates are not supported, convert " << fname << " with bin2vipr first" << endl;
+      return rs;
    }
-   else
+
+   string htmlBase = stripCompressionSuffix(fname);
+
+   if( openPage( pageName( htmlBase, 1 ) ) )
    {
 
       auto _checkVersion = [](string ver) {
@@ -154,17 +298,10 @@ int main(int argc, char *argv[])
       int num, idx, numCon, numSol, numDer, numBnd;
       int con1, asm1, con2, asm2; // for reading unsplitting indices
       bool stat = false;
-
-      html << "<HTML>" << endl;
-      html << "<HEAD>" << endl;
-      html << "<STYLE>" << endl;
-      html << "TABLE, TH, TD {" << endl;
-      html << "   border-collapse: collapse;" << endl;
-      html << "   border: 1px solid black;" << endl;
-      html << "}" << endl;
-      html << "</STYLE>" << endl;
-      html << "</HEAD>" << endl;
-      html << "<BODY>" << endl;
+      int page = 1;
+      int numShown = 0;
+      int target = -1;
+      vector<bool> isShown; // derivations shown with --label
 
       // Eat up comment lines, if any, until hitting VER
       for(;;)
@@ -176,7 +313,7 @@ int main(int argc, char *argv[])
          if (section == "VER")
          {
             pf >> tmp;
-            html << "<P> Certificate version " << tmp << "</P>" << endl;
+            html << "<P> Certificate version " << tmp << "</P>" << '\n';
             if( _checkVersion( tmp ))
             {
       break;
@@ -265,14 +402,14 @@ int main(int argc, char *argv[])
          goto TERMINATE;
       }
 
-      html << "<TABLE cellpadding='8'>" << endl;
-      html << "<TR><TD>OBJ</TD>" << endl;
-      html << "<TD>" << endl;
+      html << "<TABLE cellpadding='8'>" << '\n';
+      html << "<TR><TD>OBJ</TD>" << '\n';
+      html << "<TD>" << '\n';
 
       stat = _processSparseVec( colName, false );
 
-      html << "</TD>" << endl;
-      html << "</TABLE>" << endl;
+      html << "</TD>" << '\n';
+      html << "</TABLE>" << '\n';
 
 
       if( !stat ) goto TERMINATE;
@@ -287,18 +424,18 @@ int main(int argc, char *argv[])
 
       pf >> numCon >> numBnd;
 
-      html << "<P><B>Subject To:</B></P>" << endl;
-      html << "<TABLE cellpadding='8'>" << endl;
+      html << "<P><B>Subject To:</B></P>" << '\n';
+      html << "<TABLE cellpadding='8'>" << '\n';
 
       for( int i = 0; i < numCon; ++i )
       {
-         html << "<TR>" << endl;
+         html << "<TR>" << '\n';
          pf >> label >> sense >> tmp;
 
          rowName.push_back( label );
 
-         html << "<TD> " << i << " </TD>" << endl;
-         html << "<TD> " << label << " </TD>" << endl;
+         html << "<TD> " << i << " </TD>" << '\n';
+         html << "<TD> " << label << " </TD>" << '\n';
          html << "<TD> ";
 
          stat = _processSparseVec( colName, false );
@@ -310,16 +447,16 @@ int main(int argc, char *argv[])
              else stat = false;
              html << tmp;
          }
-         html << " </TD>" << endl;
+         html << " </TD>" << '\n';
 
-         if( i >= numCon - numBnd ) html << "<TD> bound </TD>" << endl;
+         if( i >= numCon - numBnd ) html << "<TD> bound </TD>" << '\n';
 
-         html << "</TR>" << endl;
+         html << "</TR>" << '\n';
 
          if( !stat ) break;
       }
 
-      html << "</TABLE>" << endl;
+      html << "</TABLE>" << '\n';
 
 
       pf >> section;
@@ -331,27 +468,27 @@ int main(int argc, char *argv[])
 
       pf >> tmp;
 
-      html << "<P><B>Check:</B></P>" << endl;
+      html << "<P><B>Check:</B></P>" << '\n';
       if( tmp == "infeas" )
       {
-         html << "<P>infeasible</P>" << endl;
+         html << "<P>infeasible</P>" << '\n';
       }
       else if( tmp == "range" )
       {
-         html << "<TABLE cellpadding='8'>" << endl;
+         html << "<TABLE cellpadding='8'>" << '\n';
          pf >> tmp;
          if( tmp != "-inf" )
          {
             html << "<TR><TD>lower bound</TD><TD>"
-                   << tmp << "</TD></TR>" << endl;
+                   << tmp << "</TD></TR>" << '\n';
          }
          pf >> tmp;
          if( tmp != "inf" )
          {
             html << "<TR><TD>upper bound</TD><TD>"
-                   << tmp << "</TD></TR>" << endl;
+                   << tmp << "</TD></TR>" << '\n';
          }
-         html << "</TABLE>" << endl;
+         html << "</TABLE>" << '\n';
       }
       else
       {
@@ -370,15 +507,15 @@ int main(int argc, char *argv[])
 
       if (numSol)
       {
-         html << "<P><B>Solutions:</B></P>" << endl;
-         html << "<TABLE cellpadding='8'>" << endl;
+         html << "<P><B>Solutions:</B></P>" << '\n';
+         html << "<TABLE cellpadding='8'>" << '\n';
          for( int i = 0; i < numSol; ++i ) {
             pf >> label;
             html << "<TR><TD>" << label << "</TD><TD>";
             stat = _processSparseVec( colName, true );
-            html << "</TD></TR>" << endl;
+            html << "</TD></TR>" << '\n';
          }
-         html << "</TABLE>" << endl;
+         html << "</TABLE>" << '\n';
       }
 
 
@@ -391,18 +528,106 @@ int main(int argc, char *argv[])
 
       pf >> numDer;
 
-      html << "<P><B>Derivations:</B></P>" << endl;
-      html << "<TABLE cellpadding='8'>" << endl;
+      // with --label, find the derivations the chosen constraint depends on before writing any
+      if( !targetLabel.empty() )
+      {
+         streampos fposDer = pf.tellg();
+         vector<vector<int>> needs;
+
+         for( int i = 0; i < numCon; ++i )
+         {
+            if( rowName[i] == targetLabel )
+            {
+               cerr << targetLabel << " is not derived" << endl;
+               stat = false;
+               goto TERMINATE;
+            }
+         }
+
+         for( int i = 0; i < numDer && target < 0; ++i )
+         {
+            needs.emplace_back();
+            if( !scanDependencies( numCon, label, needs.back() ) )
+            {
+               cerr << "Failed to read derivation " << i << endl;
+               stat = false;
+               goto TERMINATE;
+            }
+            if( label == targetLabel ) target = i;
+         }
+
+         if( target < 0 )
+         {
+            cerr << "No derivation with label " << targetLabel << endl;
+            stat = false;
+            goto TERMINATE;
+         }
+
+         isShown.assign( target + 1, false );
+         isShown[target] = true;
+         for( int i = target; i >= 0; --i )
+         {
+            if( !isShown[i] ) continue;
+            for( auto m : needs[i] )
+            {
+               if( m < i ) isShown[m] = true;
+            }
+         }
+
+         pf.clear();
+         pf.seekg( fposDer );
+         if( pf.fail() )
+         {
+            cerr << "Failed to return to the DER section" << endl;
+            stat = false;
+            goto TERMINATE;
+         }
+
+         html << "<P>Derivations that " << targetLabel << " depends on</P>" << '\n';
+      }
+
+      html << "<P><B>Derivations:</B></P>" << '\n';
+      html << "<TABLE cellpadding='8'>" << '\n';
 
       for( int i = 0; i < numDer; ++i )
       {
-         html << "<TR>" << endl;
+         bool show = isShown.empty() || isShown[i];
+
+         if( show && pageSize > 0 && numShown == page * pageSize )
+         {
+            // continue on the next page
+            string next = pageName( htmlBase, page + 1 );
+
+            html << "</TABLE>" << '\n';
+            html << "<P><A HREF='" << linkName( next ) << "'>next page</A></P>" << '\n';
+            closePage();
+
+            if( !openPage( next ) )
+            {
+               stat = false;
+               break;
+            }
+            html << "<P><A HREF='" << linkName( pageName( htmlBase, page ) ) << "'>previous page</A></P>" << '\n';
+            html << "<TABLE cellpadding='8'>" << '\n';
+            page++;
+         }
+
+         if( show )
+         {
+            html.rdbuf( htmlFile.rdbuf() );
+            html.clear();
+            numShown++;
+         }
+         else
+            html.rdbuf( nullptr );
+
+         html << "<TR>" << '\n';
          pf >> label >> sense >> tmp;
 
          rowName.push_back( label );
 
-         html << "<TD> " << numCon + i << " </TD>" << endl;
-         html << "<TD> " << label << " </TD>" << endl;
+         html << "<TD> " << numCon + i << " </TD>" << '\n';
+         html << "<TD> " << label << " </TD>" << '\n';
          html << "<TD> ";
          stat = _processSparseVec( colName, false );
          if( stat )
@@ -413,7 +638,7 @@ int main(int argc, char *argv[])
             else stat = false;
             html << tmp;
          }
-         html << " </TD>" << endl;
+         html << " </TD>" << '\n';
 
          html << "<TD> ";
          pf >> tmp;
@@ -499,7 +724,7 @@ int main(int argc, char *argv[])
 
          }
 
-         html << " </TD>" << endl;
+         html << " </TD>" << '\n';
 
          if( stat )
          {
@@ -509,23 +734,28 @@ int main(int argc, char *argv[])
             html << "</TD>";
          }
 
-         html << "</TR>" << endl;
+         html << "</TR>" << '\n';
 
-         if( !stat ) break;
+         if( !stat || i == target ) break;
       }
 
-      html << "</TABLE>" << endl;
+      html.rdbuf( htmlFile.rdbuf() );
+      html.clear();
+      html << "</TABLE>" << '\n';
       if( stat ) rs = 0;
 
 TERMINATE:
       if( !stat ) {
+         html.rdbuf( htmlFile.rdbuf() );
+         html.clear();
          html << "<P style='color:red;'>";
          html << "Error encountered while processing file";
-         html << "</P>" << endl;
+         html << "</P>" << '\n';
       }
-      html << "</BODY>" << endl;
-      html << "</HTML>" << endl;
-      html.close();
+      closePage();
+
+      if( page > 1 )
+         cout << "Wrote " << page << " pages" << endl;
    }
 
    pf.close();
@@ -0,0 +1,150 @@
+/*
+*
+*   Copyright (c) 2016 Kevin K. H. Cheung
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+// Checks certificates through the library interface of vipr.hpp, from memory, from a callback, and
+// with two checkers running at once in different threads
+//
+// The certificate file is given as argument; a copy with an unsplit assumption index out of range has
+// to be rejected, and so has compressed input given to checkStream. The exit status is 0 iff every
+// check gave the expected result.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "vipr.hpp"
+
+using namespace std;
+
+static int failures = 0;
+
+
+static void expect(bool condition, const string &what)
+{
+   if( !condition )
+   {
+      cerr << "FAILED: " << what << endl;
+      failures++;
+   }
+   else
+      cout << "ok: " << what << endl;
+}
+
+
+// checks the certificate through a callback that delivers at most chunkSize bytes at a time
+static bool checkInChunks(vipr::Checker &checker, const string &certificate, size_t chunkSize)
+{
+   size_t position = 0;
+
+   return checker.checkStream([&](char* buffer, size_t size) {
+      size_t n = min(min(size, chunkSize), certificate.size() - position);
+      memcpy(buffer, certificate.data() + position, n);
+      position += n;
+      return n;
+   });
+}
+
+
+int main(int argc, char* argv[])
+{
+   if( argc != 2 )
+   {
+      cerr << "usage: " << argv[0] << " <certificateFile>" << endl;
+      return 1;
+   }
+
+   ifstream file(argv[1], ios::binary);
+   stringstream content;
+
+   content << file.rdbuf();
+   if( file.fail() )
+   {
+      cerr << "Failed to read file " << argv[1] << endl;
+      return 1;
+   }
+
+   const string certificate = content.str();
+
+   // the last unsplit discharges an assumption that does not exist
+   string outOfRange = certificate;
+   size_t uns = outOfRange.rfind("uns");
+   size_t end = outOfRange.find('}', uns);
+
+   if( uns == string::npos || end == string::npos )
+   {
+      cerr << "The certificate has no unsplit" << endl;
+      return 1;
+   }
+   outOfRange.replace(uns, end - uns, "uns 0 0 0 1000000 ");
+
+   {
+      ostringstream out, err;
+      vipr::Checker checker(out, err);
+
+      expect(checker.checkBuffer(certificate.data(), certificate.size()), "checkBuffer accepts the certificate");
+      expect(checkInChunks(checker, certificate, 7), "checkStream accepts the certificate in chunks of 7 bytes");
+      expect(checkInChunks(checker, certificate, certificate.size()), "checkStream accepts the certificate at once");
+      expect(!checker.checkBuffer(outOfRange.data(), outOfRange.size())
+         && err.str().find("asm2 out of bounds") != string::npos, "checkBuffer rejects an unsplit out of range");
+   }
+
+   {
+      ostringstream out, err;
+      vipr::Checker checker(out, err);
+      const string gzipped = string("\x1f\x8b\x08\x00", 4) + "not really compressed";
+
+      expect(!checkInChunks(checker, gzipped, gzipped.size())
+         && err.str().find("Compressed input has to be given as a file or a buffer") != string::npos,
+         "checkStream reports compressed input to the error stream of the checker");
+   }
+
+   // two checkers at once, each with its own streams
+   for( int round = 0; round < 10; ++round )
+   {
+      ostringstream out1, err1, out2, err2;
+      bool result1 = false;
+      bool result2 = true;
+
+      thread first([&]() {
+         vipr::Checker checker(out1, err1);
+         result1 = checker.checkBuffer(certificate.data(), certificate.size());
+      });
+      thread second([&]() {
+         vipr::Checker checker(out2, err2);
+         result2 = checkInChunks(checker, outOfRange, 5);
+      });
+
+      first.join();
+      second.join();
+
+      expect(result1 && err1.str().empty(), "round " + to_string(round) + ": the first thread accepts the certificate");
+      expect(!result2 && err2.str().find("asm2 out of bounds") != string::npos,
+         "round " + to_string(round) + ": the second thread rejects the unsplit out of range");
+   }
+
+   return (failures == 0) ? 0 : 1;
+}
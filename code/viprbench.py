@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+#
+#   Copyright (c) 2024 Zuse Institute Berlin
+#
+#   Permission is hereby granted, free of charge, to any person obtaining a
+#   copy of this software and associated documentation files (the "Software"),
+#   to deal in the Software without restriction, including without limitation
+#   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+#   and/or sell copies of the Software, and to permit persons to whom the
+#   Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included in
+#   all copies or substantial portions of the Software.
+#
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+#   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+#   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+#   DEALINGS IN THE SOFTWARE.
+#
+
+"""Benchmarks viprchk, viprchk_parallel and viprcomp on synthetic certificates.
+
+Certificates of a few shapes are generated by viprgen, every tool is run on
+them at several thread counts, and the wall clock times of the runs together
+with the phase times, counters and peak memory the tools write with --stats
+are written as JSON; tools whose usage does not list --stats are only timed. With --compare, the results
+are checked against an earlier JSON file and slowdowns beyond the tolerance
+make the script fail, so that throughput regressions are caught.
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import time
+
+# shapes of the generated certificates, the keys are options of viprgen
+SHAPES = {
+    "small": dict(variables=200, constraints=200, depth=4, width=250, density=4, bits=4),
+    "deep": dict(variables=500, constraints=500, depth=20, width=250, density=3, bits=1),
+    "wide": dict(variables=2000, constraints=2000, depth=3, width=2000, density=6, bits=2),
+    "bigcoef": dict(variables=300, constraints=300, depth=3, width=300, density=4, bits=32),
+}
+
+# lines that show a verified certificate or a successful completion; a single shard
+# only reports "Shard i/k checked", which is not a verified certificate
+SUCCESS = r"Successfully verified|Infeasibility verified|Certificate verified by all|Completion of File successful"
+
+
+def run(command, timeout):
+    """Runs command, returns its wall clock time, exit code and output."""
+    start = time.perf_counter()
+    try:
+        process = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                 universal_newlines=True, timeout=timeout)
+        output, returncode = process.stdout, process.returncode
+    except subprocess.TimeoutExpired:
+        output, returncode = "", None
+    return time.perf_counter() - start, returncode, output
+
+
+def supportsStats(args, tool, cache={}):
+    """Whether the usage of tool advertises --stats; older builds are only timed."""
+    if tool not in cache:
+        wall, returncode, output = run([os.path.join(args.bindir, tool)], args.timeout)
+        cache[tool] = "--stats=" in output
+        if not cache[tool]:
+            print("   %s has no --stats, only its wall clock time is measured" % tool, flush=True)
+    return cache[tool]
+
+
+def readStats(path):
+    """Statistics written by a tool with --stats, empty if there are none."""
+    try:
+        with open(path) as statsFile:
+            return json.load(statsFile)
+    except (OSError, ValueError):
+        return {}
+
+
+def generate(args, name, shape, incomplete):
+    """Generates the certificate of a shape, returns its path and description."""
+    suffix = "_incomplete" if incomplete > 0 else ""
+    path = os.path.join(args.workdir, "bench_%s%s.vipr" % (name, suffix))
+    options = ["--%s=%s" % (key, value) for key, value in sorted(shape.items())]
+    options += ["--incomplete=%g" % incomplete, "--seed=%d" % args.seed]
+
+    wall, returncode, output = run([os.path.join(args.bindir, "viprgen")] + options + [path], None)
+    if returncode != 0:
+        sys.exit("viprgen failed for shape %s:\n%s" % (name, output))
+
+    return path, {"bytes": os.path.getsize(path),
+                  "derivations": shape["depth"] * shape["width"] + 1,
+                  "incomplete": incomplete,
+                  "generation": wall}
+
+
+def measure(args, tool, threads, options, path):
+    """Runs tool --repeat times on a certificate and summarizes the runs."""
+    walls, runStats, status = [], [], "verified"
+    statsPath = os.path.join(args.workdir, "bench_stats.json")
+    statsOptions = ["--stats=" + statsPath] if supportsStats(args, tool) else []
+
+    for _ in range(args.repeat):
+        if os.path.exists(statsPath):
+            os.remove(statsPath)
+        wall, returncode, output = run([os.path.join(args.bindir, tool)] + statsOptions + options + [path],
+                                       args.timeout)
+        if returncode is None:
+            status = "timeout"
+            break
+        if returncode != 0 or not re.search(SUCCESS, output):
+            status = "failed"
+            break
+        walls.append(wall)
+        runStats.append(readStats(statsPath))
+
+    if os.path.exists(statsPath):
+        os.remove(statsPath)
+
+    result = {"tool": tool, "threads": threads, "status": status, "wall": walls}
+    if walls:
+        result["median"] = statistics.median(walls)
+        result["min"] = min(walls)
+    if walls and all(runStats):
+        phases = [stats.get("phases", {}) for stats in runStats]
+        result["phases"] = {phase: statistics.median(p[phase] for p in phases)
+                            for phase in phases[0] if all(phase in p for p in phases)}
+        result["peak_rss_kb"] = max(stats.get("peak_rss_kb", 0) for stats in runStats)
+        result["counters"] = runStats[-1].get("counters", {})
+
+    print("   %-17s threads %3d  %-8s %s" % (tool, threads, status,
+          "%.3f s" % result["median"] if walls else ""), flush=True)
+    return result
+
+
+def benchmark(args):
+    available = {tool: os.path.exists(os.path.join(args.bindir, tool))
+                 for tool in ("viprchk", "viprchk_parallel", "viprcomp")}
+    results = []
+
+    for name in args.shapes:
+        shape = SHAPES[name]
+        print("shape %s: %s" % (name, " ".join("%s=%s" % item for item in sorted(shape.items()))), flush=True)
+
+        path, certificate = generate(args, name, shape, 0)
+        entry = {"shape": name, "parameters": shape, "certificate": certificate, "runs": []}
+
+        if available["viprchk"]:
+            entry["runs"].append(measure(args, "viprchk", 1, [], path))
+        if available["viprchk_parallel"]:
+            for threads in args.threads:
+                entry["runs"].append(measure(args, "viprchk_parallel", threads, ["--threads=%d" % threads], path))
+
+        if available["viprcomp"] and args.incomplete > 0:
+            incompletePath, entry["incomplete_certificate"] = generate(args, name, shape, args.incomplete)
+            for threads in args.threads:
+                completed = os.path.join(args.workdir, "bench_%s_completed.vipr" % name)
+                entry["runs"].append(measure(args, "viprcomp", threads,
+                                             ["--threads=%d" % threads, "--outfile=%s" % completed],
+                                             incompletePath))
+                if not args.keep and os.path.exists(completed):
+                    os.remove(completed)
+            if not args.keep:
+                os.remove(incompletePath)
+
+        if not args.keep:
+            os.remove(path)
+        results.append(entry)
+
+    return results
+
+
+def compare(results, baseline, tolerance):
+    """Prints runs that are slower than in the baseline, returns their number."""
+    reference = {(entry["shape"], run["tool"], run["threads"]): run
+                 for entry in baseline["results"] for run in entry["runs"] if "median" in run}
+    regressions = 0
+
+    for entry in results:
+        for run in entry["runs"]:
+            old = reference.get((entry["shape"], run["tool"], run["threads"]))
+            if old is None:
+                continue
+            if run["status"] != "verified":
+                print("%s %s threads %d: %s, was verified" % (entry["shape"], run["tool"], run["threads"], run["status"]))
+                regressions += 1
+            elif run["median"] > old["median"] * (1 + tolerance):
+                print("%s %s threads %d: %.3f s instead of %.3f s (%+.0f%%)"
+                      % (entry["shape"], run["tool"], run["threads"], run["median"], old["median"],
+                         100 * (run["median"] / old["median"] - 1)))
+                regressions += 1
+
+    return regressions
+
+
+def main():
+    cpus = os.cpu_count() or 1
+    defaultThreads = sorted({1, 2, 4, 8, 16, 32, 64, cpus} & set(range(1, cpus + 1)))
+
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--bindir", default=".", help="directory of the vipr binaries")
+    parser.add_argument("--workdir", default=".", help="directory for the generated certificates")
+    parser.add_argument("--output", default="benchmark.json", help="JSON file for the results")
+    parser.add_argument("--shapes", default="small,deep,wide,bigcoef",
+                        help="comma separated shapes out of " + ",".join(SHAPES))
+    parser.add_argument("--threads", default=",".join(map(str, defaultThreads)),
+                        help="comma separated thread counts for viprchk_parallel and viprcomp")
+    parser.add_argument("--incomplete", type=float, default=20,
+                        help="percentage of incomplete derivations for viprcomp (0 = skip viprcomp)")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per measurement, the median is reported")
+    parser.add_argument("--seed", type=int, default=0, help="seed of viprgen")
+    parser.add_argument("--timeout", type=float, default=3600, help="seconds until a run is stopped")
+    parser.add_argument("--keep", action="store_true", help="keep the generated certificates")
+    parser.add_argument("--compare", help="JSON file of an earlier run to compare with")
+    parser.add_argument("--tolerance", type=float, default=0.1,
+                        help="relative slowdown that counts as regression (default 0.1)")
+    args = parser.parse_args()
+
+    args.shapes = args.shapes.split(",")
+    args.threads = [int(t) for t in args.threads.split(",")]
+    for name in args.shapes:
+        if name not in SHAPES:
+            parser.error("unknown shape " + name)
+
+    results = {
+        "version": 1,
+        "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "host": {"name": platform.node(), "system": platform.platform(), "cpus": cpus},
+        "seed": args.seed,
+        "repeat": args.repeat,
+        "results": benchmark(args),
+    }
+
+    with open(args.output, "w") as out:
+        json.dump(results, out, indent=2)
+        out.write("\n")
+    print("results written to " + args.output)
+
+    if args.compare:
+        with open(args.compare) as baselineFile:
+            regressions = compare(results["results"], json.load(baselineFile), args.tolerance)
+        print("%d regressions compared with %s" % (regressions, args.compare))
+        return 1 if regressions else 0
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -24,23 +24,39 @@
 */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <iterator>
 #include <string>
 #include <map>
+#include <sstream>
 #include <vector>
 #include <cassert>
+#include <climits>
 #include <gmpxx.h>
 #include <cstdio>
 #include <memory>
+#include <queue>
 #include <thread>
 #include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+#include "stats.hpp"
+#include "certificate.hpp"
+#include "gmpalloc.hpp"
 
 // Timing
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 // Parallelization
 #include <tbb/tbb.h>
+#ifdef VIPR_WITH_MPI
+#include <mpi.h>
+#endif
 
 // Avoid using namespace std to avoid non-obvious complications (ambiguities)
 using std::map;
@@ -52,208 +68,113 @@ using std::make_shared;
 using std::cerr;
 using std::endl;
 using std::cout;
+using std::pair;
+using vipr::SVectorGMP;
+using vipr::ArithmeticCounts;
+using vipr::DenseAccumulator;
+using vipr::AssumptionSet;
+using vipr::Constraint;
+using vipr::DerivationType;
+using vipr::RelationToProveType;
+using vipr::emptyList;
+using vipr::isInteger;
 
-// Types
-typedef map<int, bool> SVectorBool;
+// Globals
+unsigned int nthreads = std::thread::hardware_concurrency();
+size_t windowSize = 10000; // number of LIN/RND/UNS derivations per pipeline window (0 = whole DER section)
+const size_t maxLiveWindows = 4; // number of windows that are processed simultaneously
+tbb::task_arena limitedArena; // arena limited to nthreads used for all parallel checks
+tbb::enumerable_thread_specific<DenseAccumulator> accumulators; // per-thread buffers for checkLinComb
+tbb::enumerable_thread_specific<ArithmeticCounts> arithmeticCounts; // per-thread statistics of exact arithmetic
+int shardIndex = 0; // this process checks the LIN, RND and UNS derivations i with i % numberOfShards == shardIndex
+int numberOfShards = 1; // number of processes that check the certificate together
+double followTimeout = -1; // seconds to wait for a growing certificate to be appended to (-1 = no follow mode)
+int followFd = -1; // certificate that is read in follow mode
+const char* checkpointFileName = nullptr; // checkpoint that is written while checking the DER section
+double checkpointInterval = 600; // seconds between two checkpoints
+bool resume = false; // continue from the checkpoint instead of the first derivation
+std::thread checkpointWriter; // writes the last checkpoint to disk, so that committing does not wait
+timeval lastCheckpoint; // time the last checkpoint was taken
+Stats stats; // phase times and counters, written to statsFileName
+const char* statsFileName = nullptr; // JSON file for the statistics (--stats)
+bool certificateOpened = false; // statistics are only written if the certificate could be opened
+double progressInterval = 60; // seconds between two progress lines (0 = none)
+#ifdef VIPR_WITH_MPI
+int mpiRank = 0;
+int mpiSize = 1;
+#endif
 
-// The type of derivation used to derive a constraint
-enum DerivationType
+// A derivation whose assumption list is set in order of appearance
+struct PendingCommit
 {
-   ASM,   // assumption
-   LIN,   // simple implication
-   RND,   // simple implication with integer rounding; i.e. a CG cut
-   UNS,   // unsplit operation
-   SOL,   // cutoff bound from primal solution
-   UNKNOWN
+   size_t conIdx; // index of the derived constraint
+   DerivationType type;
+   size_t linCombIdx; // index into the window buffers for LIN and RND
+   int con1, asm1, con2, asm2; // unsplit information for UNS
 };
 
-// The type of relation to prove
-enum RelationToProveType
+// A consecutive range of derivations that is read, checked and committed at once
+struct DerivationWindow
 {
-   INFEAS,   // infeasible
-   RANGE   // lower bound (-inf if none) and upper bound (inf if none) to be verified
+   vector<Constraint> toCheck;
+   vector<SVectorGMP> mults;
+   vector<size_t> indicesToChk;
+   vector<int> correspondingSenses;
+   vector<DerivationType> correspondingDerType;
+   vector<size_t> costs; // estimated cost of checking each linear combination
+   vector<size_t> unsplits; // indices into commits of the UNS derivations
+   vector<size_t> unsplitCosts; // estimated cost of checking each unsplit
+   vector<PendingCommit> commits;
+   vector<size_t> linCombsInShard; // indices into toCheck of the linear combinations checked by this process
+   vector<size_t> unsplitsInShard; // indices into unsplits of the unsplits checked by this process
+   bool last = false; // the certificate ends with this window
+   std::streampos endPos; // position in the certificate after the last derivation of this window
+   size_t endReadChecks = 0; // numberOfReadChecks after the last derivation of this window
+   int startIdx = 0; // index of the first constraint derived in this window
+   int endIdx = 0; // index after the last constraint derived in this window
+   bool success = true;
 };
 
+vector<double> threadBusyTime; // seconds spent checking linear combinations per arena thread
 
-// Classes
-// Sparse vectors of rational numbers as maps
-class SVectorGMP : public map<int, mpq_class>
-{
-   public:
-      void compactify() {  if( !_compact )
-                           {
-                              auto it = this->begin();
-                              while( it != this->end() )
-                              {
-                                 if( it->second == 0 ) this->erase(it++);
-                                 else ++it;
-                              }
-                              _compact = true;
-                           }
-                        }
-      bool operator!=(SVectorGMP &other);
-      bool operator==(SVectorGMP &other) { return !(*this != other);}
-      SVectorGMP operator-(const SVectorGMP &other)
-      {
-         SVectorGMP returnsvec(*this);
-         for(auto it = other.begin(); it != other.end(); ++it)
-         {
-            returnsvec[it->first] -= it->second;
-         }
-
-         return returnsvec;
-      }
-
-   private:
-      bool _compact = false;
-};
-
-// Constraint format
-class Constraint
+// Checks a certificate with the DER section read in windows, whose derivations are checked in
+// parallel; with several shards, only the derivations of this process's shard are checked
+class ParallelCheck : public vipr::Certificate
 {
    public:
-      Constraint() {}
-
-      Constraint( const string label, const int sense, const mpq_class rhs,
-                  shared_ptr<SVectorGMP> coefficients, const bool isAssumptionCon,
-                  const SVectorBool assumptionList):
-
-                  _label(label), _sense(sense), _rhs(rhs), _coefficients(coefficients),
-                  _isAssumption(isAssumptionCon), _assumptionList(assumptionList)
-                  {
-                     _coefficients->compactify();
-                     _trashed = false;
-                     _falsehood = _isFalsehood();
-                  }
-
-      bool round();
-
-      mpq_class getRhs() const { return _rhs; }
-      mpq_class getCoef(const int index) { if( _coefficients->find(index) != _coefficients->end() )
-                                              return (*_coefficients)[index];
-                                           else return mpq_class(0); }
-
-      shared_ptr<SVectorGMP> coefSVec() const { return _coefficients; }
-
-      int getSense() const { return _sense; }
-
-      bool isAssumption() { return _isAssumption; }
-
-      bool isFalsehood() const { return _falsehood; }
-                  // true iff the constraint is a contradiction like 0 >= 1
-
-      bool isTautology();
-                  // true iff the constraint is a tautology like 0 <= 1
-
-      bool hasAsm(const int index) {
-               return (_assumptionList.find(index) != _assumptionList.end());
-            }
-
-      void setassumptionList(const SVectorBool assumptionList) { _assumptionList = assumptionList; }
-      SVectorBool getassumptionList() const { return _assumptionList; }
-
-      bool dominates(Constraint &other) const;
-      void print();
-
-      void trash() { _trashed = true; _falsehood = false; _coefficients = nullptr;
-                     _rhs = 0; _assumptionList.clear(); }
-      bool isTrashed() const { return _trashed; }
+      ParallelCheck(Stats &stats) : Certificate(cout, cerr, stats) {}
 
-      string label() const { return _label; }
-
-      void setMaxRefIdx(int refIdx) { _refIdx = refIdx; }
-      int getMaxRefIdx() { return _refIdx; }
-
-      Constraint operator-(const Constraint& other)
-      {
-         Constraint returncons(*this);
-         for(auto it = other._coefficients->begin(); it != other._coefficients->end(); ++it)
-         {
-            (*returncons._coefficients)[it->first] -= it->second;
-         }
-
-         returncons._rhs -= other._rhs;
-         return returncons;
-      }
+      // checks the certificate given on the command line, returns 0 iff it is verified
+      int checkCertificate(int argc, char *argv[]);
+      void writeStats(bool verified);
 
    private:
-      string _label;
-      int _sense;
-      mpq_class _rhs;
-      shared_ptr<SVectorGMP> _coefficients;
-      int _refIdx = -1;
-      bool _isAssumption;
-      SVectorBool _assumptionList; // constraint index list that are assumptions
-      bool _falsehood;
-
-      bool _isFalsehood();
-      bool _trashed;
+      int numberOfReadDerivations = 0; // number of derivations read so far
+      size_t numberOfReadChecks = 0; // number of LIN, RND and UNS derivations read so far, assigns them to shards
+      bool derivationsEnded = false; // in follow mode, the certificate ended before numberOfDerivations were read
+      size_t numberOfCheckedLinCombs = 0; // number of LIN and RND derivations checked so far
+      size_t numberOfCheckedUnsplits = 0; // number of UNS derivations checked so far
+      std::atomic<bool> checkFailed{false}; // set by any pipeline stage on failure
+
+      // constraints that may be trashed, ordered by their maximal reference index
+      std::priority_queue<pair<int, int>, vector<pair<int, int>>, std::greater<pair<int, int>>> trashQueue;
+
+      bool processSOL();
+      bool processDER();
+      bool checkResult();
+      bool readDerivationWindow(DerivationWindow &window);
+      bool parCheck_Derivations(DerivationWindow &window);
+      bool commitDerivationWindow(DerivationWindow &window);
+      void trashConstraints(const int numberOfVerified);
+      void writeCheckpoint(const DerivationWindow &window);
+      bool readCheckpoint();
+      bool chkLinearCombinations(DerivationWindow &window, size_t i);
+      bool chkUnsplit(DerivationWindow &window, size_t i);
 };
 
-
-// Globals
-const SVectorBool emptyList;
-unsigned int nthreads = std::thread::hardware_concurrency();
-
-int numberOfVariables = 0; // number of variables
-int numberOfConstraints = 0; // number of constraints
-int numberOfBounds = 0; // number of bounds
-int numberOfDerivations = 0; // number od derivations
-int numberOfSolutions = 0; // number of solutions
-vector<bool> isInt; // integer variable indices
-vector<string> variable; // variable names
-vector<Constraint> constraint; // all the constraints, including derived ones
-vector<SVectorGMP> solution; // all the solutions for checking feasibility
-ifstream certificateFile;   // certificate file stream
-
-vector<SVectorGMP> mults;
-vector<Constraint> toCheck;
-vector<size_t> indicesToChk;
-vector<int> correspondingSenses;
-vector<DerivationType> correspondingDerType;
-
-RelationToProveType relationToProveType;
-mpq_class bestObjectiveValue; // best objective function value of specified solutions
-mpq_class lowerBound; // lower bound for optimal value to be checked
-mpq_class upperBound; // upper bound for optimal value to be checked
-string lowerStr, upperStr;
-bool isMin; // is minimization problem
-bool checkLower; // true iff need to verify lower bound
-bool checkUpper; // true iff need to verify upper bound
-Constraint relationToProve; // constraint to be derived in the case of bound checking
-shared_ptr<SVectorGMP> objectiveCoefficients(make_shared<SVectorGMP>()); // obj coefficients
-bool objectiveIntegral;
-
 // Forward declaration
-bool checkVersion(string ver);
-bool processVER();
-bool processVAR();
-bool processINT();
-bool processOBJ();
-bool processCON();
-bool processRTP();
-bool processSOL();
-bool seqCheck_Der();
-bool parCheck_Der();
-bool chkLinearCombinations(size_t i);
-// bool processDER();
-
-bool readMultipliers(int &sense, SVectorGMP &mult);
-bool readConstraintCoefficients(shared_ptr<SVectorGMP> &v);
-bool readConstraint( string &label, int &sense, mpq_class &rhs,
-                     shared_ptr<SVectorGMP> &coef);
-
-inline mpq_class floor(const mpq_class &q); // rounding down
-inline mpq_class ceil(const mpq_class &q); // rounding up
-bool isInteger(const mpq_class &q); // check if variable is integer
-
-mpq_class scalarProduct(shared_ptr<SVectorGMP> u, shared_ptr<SVectorGMP> v);
-
-bool canUnsplit(  Constraint &toDer, const int con1, const int a1, const int con2,
-                  const int a2, SVectorBool &assumptionList);
-
-bool readLinComb( mpq_class &rhs, shared_ptr<SVectorGMP> coef,
-                  int currConIdx, SVectorBool &amsList, SVectorGMP &mult);
+void printThreadBusyTimes();
+void printArithmeticCounts();
 
 
 static double getTimeSecs(timeval start, timeval end)
@@ -264,12 +185,49 @@ static double getTimeSecs(timeval start, timeval end)
    return clock_dur;
 }
 
+// Reads the certificate in follow mode while it is still being written
+// Returns whatever is available, so derivations are checked as they arrive. At the end of a regular file,
+// waits until more is appended or followTimeout seconds passed without new input; a pipe ends when
+// the writer closes it
+static size_t followRead(char* buffer, size_t size, bool isPipe)
+{
+   const double pause = 0.1;
+   double waited = 0;
+
+   while( true )
+   {
+      ssize_t n = ::read(followFd, buffer, size);
+
+      if( n < 0 && errno == EINTR )
+         continue;
+      if( n < 0 )
+         return 0;
+      if( n > 0 || isPipe || waited >= followTimeout )
+         return n;
+
+      std::this_thread::sleep_for(std::chrono::duration<double>(pause));
+      waited += pause;
+   }
+}
+
 // Set usage options
 static void printUsage(const char* const argv[], int idx)
 {
    const char* usage =
       "general options:\n"
       "  --threads=<number>     maximal number of threads to use \n"
+      "  --window=<number>      number of lin/rnd/uns derivations per window; reading the next windows overlaps\
+      \n                         with checking the current one (0 = read whole DER section first)\n"
+      "  --shard=<i>/<k>        check only every k-th lin/rnd/uns derivation, starting with the i-th (0 <= i < k);\
+      \n                         the certificate is verified if all k shards are verified\n"
+      "  --follow=<seconds>     check a certificate that is still being written; waits at its end until nothing\
+      \n                         was appended for the given time, the number of derivations is an upper bound\n"
+      "  --checkpoint=<file>    periodically save the state of the check of the DER section to file\n"
+      "  --checkpointinterval=<seconds>\
+      \n                         time between two checkpoints (default 600)\n"
+      "  --resume               continue from the checkpoint given by --checkpoint if it exists\n"
+      "  --stats=<file>         write phase times, counters and peak memory as JSON to file\n"
+      "  --progress=<seconds>   print the progress of the DER section every given seconds (default 60, 0 = never)\n"
       "\n";
    if(idx <= 0)
       cerr << "missing input file\n\n";
@@ -282,12 +240,59 @@ static void printUsage(const char* const argv[], int idx)
 }
 
 // Main function
+// With MPI, every process checks one shard of the derivations and the results are combined
 int main(int argc, char *argv[])
+{
+   useScalableAllocatorForGMP();
+
+   ParallelCheck parallelCheck(stats);
+
+#ifdef VIPR_WITH_MPI
+   int verified, allVerified;
+
+   MPI_Init(&argc, &argv);
+   MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank);
+   MPI_Comm_size(MPI_COMM_WORLD, &mpiSize);
+
+   verified = (parallelCheck.checkCertificate(argc, argv) == 0);
+   MPI_Allreduce(&verified, &allVerified, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+
+   if( mpiSize > 1 && mpiRank == 0 )
+   {
+      if( allVerified )
+         cout << endl << "Certificate verified by all " << mpiSize << " processes" << endl;
+      else
+         cout << endl << "Certificate not verified by at least one of " << mpiSize << " processes" << endl;
+   }
+
+   // every rank records the combined result next to the one of its shard
+   if( statsFileName != nullptr && certificateOpened )
+   {
+      if( mpiSize > 1 )
+         stats.setInfo("certificate_result", allVerified ? "verified" : "failed");
+      parallelCheck.writeStats(verified);
+   }
+
+   MPI_Finalize();
+
+   return allVerified ? 0 : -1;
+#else
+   int returnStatement = parallelCheck.checkCertificate(argc, argv);
+
+   if( statsFileName != nullptr && certificateOpened )
+      parallelCheck.writeStats(returnStatement == 0);
+
+   return returnStatement;
+#endif
+}
+
+
+int ParallelCheck::checkCertificate(int argc, char *argv[])
 {
 
    int returnStatement = -1;
    int optidx;
-   const char* certificateFileName;
+   const char* certificateFileName = nullptr;
 
 
     if( argc == 0 )
@@ -301,8 +306,8 @@ int main(int argc, char *argv[])
    {
       char* option = argv[optidx];
 
-      // we reached <certificateFile>
-      if(option[0] != '-')
+      // we reached <certificateFile>, "-" reads from stdin
+      if(option[0] != '-' || option[1] == '\0')
       {
          certificateFileName = argv[optidx];
          continue;
@@ -322,6 +327,93 @@ int main(int argc, char *argv[])
                nthreads = std::min(atoi(str), (int) nthreads);
             }
          }
+         // set size of the window of derivations that are checked at once
+         else if(strncmp(option, "window=", 7) == 0)
+         {
+            char* str = &option[7];
+            if( isdigit(option[7]))
+            {
+               windowSize = strtoul(str, nullptr, 10);
+            }
+            else
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
+         // check only one shard of the derivations
+         else if(strncmp(option, "shard=", 6) == 0)
+         {
+            char* str = &option[6];
+            char* end = nullptr;
+
+            if( isdigit(option[6]) )
+            {
+               shardIndex = strtol(str, &end, 10);
+               if( *end == '/' && isdigit(end[1]) )
+                  numberOfShards = strtol(end + 1, &end, 10);
+            }
+
+            if( end == nullptr || *end != '\0' || numberOfShards < 1 || shardIndex >= numberOfShards )
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
+         // check the certificate while it is written
+         else if(strncmp(option, "follow=", 7) == 0)
+         {
+            char* str = &option[7];
+            if( isdigit(option[7]))
+            {
+               followTimeout = atof(str);
+            }
+            else
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
+         // save the state of the check periodically
+         else if(strncmp(option, "checkpoint=", 11) == 0 && option[11] != '\0')
+         {
+            checkpointFileName = &option[11];
+         }
+         else if(strncmp(option, "checkpointinterval=", 19) == 0)
+         {
+            char* str = &option[19];
+            if( isdigit(option[19]))
+            {
+               checkpointInterval = atof(str);
+            }
+            else
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
+         else if(strcmp(option, "resume") == 0)
+         {
+            resume = true;
+         }
+         // write statistics as JSON
+         else if(strncmp(option, "stats=", 6) == 0 && option[6] != '\0')
+         {
+            statsFileName = &option[6];
+         }
+         else if(strncmp(option, "progress=", 9) == 0)
+         {
+            char* str = &option[9];
+            if( isdigit(option[9]))
+            {
+               progressInterval = atof(str);
+            }
+            else
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
          else
          {
             printUsage(argv, optidx);
@@ -330,16 +422,68 @@ int main(int argc, char *argv[])
       }
    }
 
-   certificateFile.open(certificateFileName);
+   if( resume && checkpointFileName == nullptr )
+   {
+      cerr << "--resume needs the checkpoint file given by --checkpoint" << endl;
+      return 1;
+   }
+
+#ifdef VIPR_WITH_MPI
+   // the processes are the shards
+   if( mpiSize > 1 )
+   {
+      if( numberOfShards > 1 )
+      {
+         cerr << "--shard cannot be combined with several MPI processes" << endl;
+         return 1;
+      }
+
+      shardIndex = mpiRank;
+      numberOfShards = mpiSize;
+   }
+#endif
 
-   if( certificateFile.fail() )
+   if( certificateFileName == nullptr )
    {
-      cerr << "Failed to open file " << argv[1] << endl;
+      printUsage(argv, -1);
+      return 1;
+   }
+
+   if( followTimeout >= 0 )
+   {
+      // the file is read through a callback that waits for the writer
+      struct stat st;
+      bool isPipe;
+
+      followFd = (strcmp(certificateFileName, "-") == 0) ? STDIN_FILENO : ::open(certificateFileName, O_RDONLY);
+
+      if( followFd >= 0 )
+      {
+         isPipe = (fstat(followFd, &st) != 0 || !S_ISREG(st.st_mode));
+         certificateFile.openStream([isPipe](char* buffer, size_t size) {
+            return followRead(buffer, size, isPipe);
+         });
+      }
+   }
+   else
+      certificateFile.open(certificateFileName);
+
+   if( (followTimeout >= 0 && followFd < 0) || certificateFile.fail() )
+   {
+      cerr << "Failed to open file " << certificateFileName << endl;
       return returnStatement;
    }
 
+   certificateOpened = true;
+   stats.setInfo("tool", "viprchk_parallel");
+   stats.setInfo("certificate", certificateFileName);
+
+   limitedArena.initialize(nthreads);
+   threadBusyTime.assign(nthreads, 0.0);
+   stats.setProgressInterval(progressInterval);
+
    // double start_cpu_tm = get_wall_time();
-   struct timeval start, end, startpar;
+   struct timeval start, end, startder;
    gettimeofday( &start, 0 );
    if( processVER() )
       if( processVAR() )
@@ -349,518 +493,162 @@ int main(int argc, char *argv[])
                   if( processRTP() )
                      if( processSOL() )
                      {
-                        if( seqCheck_Der() )
-                        {
-                           gettimeofday( &end, 0 );
-                           cout << endl << "Sequential part took " << getTimeSecs(start, end)
-                                 << " seconds (Wall Clock)" << endl;
-                           gettimeofday( &startpar, 0 );
-                           if( parCheck_Der() )
-                           {
-                              returnStatement = 0;
-                              gettimeofday( &end, 0 );
-                              cout << endl << "Parallel part took " << getTimeSecs(startpar, end)
-                                   << " seconds (Wall Clock)" << endl;
-                              cout << endl << "Completed in " << getTimeSecs(start, end)
-                                   << " seconds (Wall Clock)" << endl;
-                           }
-                        }
-                        else
+                        gettimeofday( &end, 0 );
+                        cout << endl << "Reading up to DER section took " << getTimeSecs(start, end)
+                              << " seconds (Wall Clock)" << endl;
+                        gettimeofday( &startder, 0 );
+                        if( processDER() && checkResult() )
                         {
+                           returnStatement = 0;
                            gettimeofday( &end, 0 );
-                           cout << endl << "Completed in " << getTimeSecs(start, end)
+                           cout << endl << "Checking DER section took " << getTimeSecs(startder, end)
                                 << " seconds (Wall Clock)" << endl;
                         }
+                        gettimeofday( &end, 0 );
+                        cout << endl << "Completed in " << getTimeSecs(start, end)
+                             << " seconds (Wall Clock)" << endl;
                      }
+
+   certificateFile.close();
+   if( followFd > STDIN_FILENO )
+      ::close(followFd);
+
    return returnStatement;
 }
 
 
-// Processes in order of appearance
-
-// Version control for .vipr input file. Backward compatibility possible for minor versions
-bool checkVersion(string version)
+// Processes solutions to be verified
+// Checks constraints and bounds
+// Error if wrong format, type or if bounds violated by solution
+bool ParallelCheck::processSOL()
 {
-   bool returnStatement = false;
+   cout << endl << "Processing SOL section..." << endl;
+   stats.startPhase("SOL");
 
-   size_t position = version.find(".");
+   bool returnStatement = false;
+   mpq_class value;
 
-   int major = atoi(version.substr(0, position).c_str());
-   int minor = atoi(version.substr(position+1, version.length()-position).c_str());
+   string section;
 
-   cout << "Certificate format version " << major << "." << minor << endl;
+   certificateFile >> section;
 
-   if( (major ==VIPR_VERSION_MAJOR) && (minor <=VIPR_VERSION_MINOR) )
-   {
-      returnStatement = true;
-   }
-   else
+   // Check format
+   if( section != "SOL" )
    {
-      cerr << "Version unsupported" << endl;
+      cerr << "SOL expected.   Read instead " << section << endl;
+      return returnStatement;
    }
 
-   return returnStatement;
-}
-
-
-// Check version and correct file format allows next process to start
-// Error if the version is incompatible or not specified
-bool processVER()
-{
-   bool returnStatement = false;
-   string tmpStr;
+   certificateFile >> numberOfSolutions;
 
-   for( ;; )
+   if( certificateFile.fail() )
    {
-      certificateFile >> tmpStr;
-      if( tmpStr == "VER" )
-      {
-         certificateFile >> tmpStr;
-         returnStatement = checkVersion(tmpStr);
-break;
-      }
-      else if( tmpStr == "%" )
-      {
-         getline(certificateFile, tmpStr);
-      }
-      else
-      {
-         cerr << endl << "Comment or VER expected. Read instead "
-                << tmpStr << endl;
-break;
-      }
+      cerr << "Failed to read number after SOL" << endl;
    }
-
-   return returnStatement;
-}
-
-
-// Processes number of variables then indexes them in order from 0 to n-1
-// Produces vector of variables
-// Error if nr of variables invalid or number of variables > specified variables or section missing
-bool processVAR()
-{
-
-   cout << endl << "Processing VAR section..." << endl;
-
-   auto returnStatement = true;
-
-   string section;
-
-   certificateFile >> section;
-
-
-   // Check section
-   if( section != "VAR" )
+   else if( numberOfSolutions < 0 )
    {
-      cerr << "VAR expected.   Read instead " << section << endl;
+      cerr << "Invalid number after SOL: " << numberOfSolutions << endl;
    }
    else
    {
-      certificateFile >> numberOfVariables; // number of variables
-
-      if( certificateFile.fail() || numberOfVariables < 0 )
+      auto satisfies = [] (Constraint &con, const vector<mpq_class> &x, ArithmeticCounts &counts)
       {
-         cerr << "Invalid number after VAR" << endl;
-         returnStatement = false;
-      }
+         bool returnStat = false;
 
+         mpq_class prod = denseActivity(*con.coefSVec(), x, counts);
 
-      // Store variables
-      else
-      {
-         for( int i = 0; i < numberOfVariables; i++ )
+         if( con.getSense() < 0 )
          {
-            string tmp;
-            certificateFile >> tmp;
-            if( certificateFile.fail() )
-            {
-               cerr << "Error reading variable for index " << i << endl;
-               returnStatement = false;
-         break;
-            }
-            variable.push_back(tmp);
+            returnStat = (prod <= con.getRhs());
+         }
+         else if( con.getSense() > 0 )
+         {
+            returnStat = (prod >= con.getRhs());
+         }
+         else
+         {
+            returnStat = (con.getRhs() == prod);
          }
-      }
-   }
-
-   return returnStatement;
-}
-
-
-// Processes number of integer variables and specifies their indices
-// Produces vector of indices of integer variables
-// Error if nr of integers invalid or nr of integers > specified integers or section missing
-bool processINT()
-{
-   cout << endl << "Processing INT section..." << endl;
-
-   bool returnStatement = false;
-
-   string section;
-
-   certificateFile >> section;
-
-
-   // Check section
-   if( section != "INT" )
-   {
-      cerr << "INT expected.   Read instead " << section << endl;
-   }
-   else
-   {
-      auto numberOfIntegers = 0;
 
-      certificateFile >> numberOfIntegers; // number of integer variables
+         return returnStat;
+      };
 
-      if( certificateFile.fail() || numberOfIntegers < 0 )
+      // all solutions are read first and then checked in parallel, each against blocks of constraints
+      struct SolutionCheck
       {
-         cerr << "Invalid number after INT" << endl;
-      }
-
+         string label;
+         shared_ptr<SVectorGMP> values;
+         int nonInteger = -1; // first integer variable with fractional value
+         int violated = -1; // first violated constraint
+         mpq_class objval;
+      };
+      vector<SolutionCheck> solutions(numberOfSolutions);
 
-      // Store integer variables
-      else
+      for( int i = 0; i < numberOfSolutions; ++i )
       {
-         isInt.resize(variable.size());
+         solutions[i].values = make_shared<SVectorGMP>();
+         certificateFile >> solutions[i].label;
 
-         for( auto it = isInt.begin(); it != isInt.end(); ++it )
+         if( !readConstraintCoefficients(solutions[i].values) )
          {
-            *it = false;
+            cout << "checking solution " << solutions[i].label << endl;
+            cerr << "Failed to read solution." << endl;
+            goto TERMINATE;
          }
+      }
 
-         if( numberOfIntegers > 0 ) {
+      limitedArena.execute([&]{
+         tbb::parallel_for(0, numberOfSolutions, [&](int i)
+         {
+            SolutionCheck &check = solutions[i];
+            vector<mpq_class> sol(numberOfVariables);
 
-            for( int i = 0; i < numberOfIntegers; ++i )
+            // Check integrality constraints
+            for( auto it = check.values->begin(); it != check.values->end(); ++it )
             {
-               int index;
-
-               certificateFile >> index;
-               if( certificateFile.fail() )
+               if( isInt[it->first] && !isInteger(it->second) )
                {
-                  cerr << "Error reading integer index " << i << endl;
-            goto TERMINATE;
+                  check.nonInteger = it->first;
+                  return;
                }
-               isInt[index] = true;
+               sol[it->first] = it->second;
             }
-         }
-         returnStatement = true;
-      }
-   }
-
-TERMINATE:
-   return returnStatement;
-}
-
-
-// Processes the sense of the objective function and coefficients for variables
-// Stores sense and runs subroutine to store coefficients
-// Error if objective sense invalid (other than -1, 0, 1 for min, equality, max) or subroutine fails
-bool processOBJ()
-{
-   cout << endl << "Processing OBJ section..." << endl;
-
-   bool returnStatement = false;
-
-   string section;
-
-   certificateFile >> section;
-
-   // Check section
-   if( section != "OBJ" )
-   {
-      cerr << "OBJ expected.   Read instead " << section << endl;
-   }
-   else
-   {
-      string objectiveSense;
-
-      certificateFile >> objectiveSense;
-
-      if( objectiveSense == "min" )
-      {
-          isMin = true;
-      }
-      else if( objectiveSense == "max" )
-      {
-          isMin = false;
-      }
-      else
-      {
-          cerr << "Invalid objective sense: " << objectiveSense << endl;
-          goto TERMINATE;
-      }
-
-      returnStatement = readConstraintCoefficients(objectiveCoefficients);
-      objectiveIntegral = true;
-
-      for( auto it = objectiveCoefficients->begin(); it != objectiveCoefficients->end(); ++it )
-      {
-         if ( !isInteger(it->second) || !isInt[it->first] )
-            objectiveIntegral = false;
-      }
-
-      if( !returnStatement )
-      {
-         cerr << "Failed to read objective coefficients" << endl;
-      }
-   }
-
-TERMINATE:
-   return returnStatement;
-}
-
-
-// Processes constraints
-// Produces vector of constraints and calls subroutine
-// Error if number of constraints or bounds smaller 0
-bool processCON()
-{
-   cout << endl << "Processing CON section..." << endl;
-
-   bool returnStatement = false;
-
-   string section;
-
-   certificateFile >> section;
-
-
-   // Check section
-   if( section != "CON" )
-   {
-      cerr << "CON expected.   Read instead " << section << endl;
-   }
-   else
-   {
-      certificateFile >> numberOfConstraints >> numberOfBounds;
-      // numberOfBounds not used in verification but useful for debugging
-
-      if( certificateFile.fail() || numberOfConstraints < 0 || numberOfBounds < 0 )
-      {
-         cerr << "Invalid number(s) after CON" << endl;
-      }
-
-
-      // Store constraints
-      else
-      {
-         string label;
-         int sense;
-         mpq_class rhs;
-
-         for( int i = 0; i < numberOfConstraints; i++ )
-         {
-            shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
-
-            returnStatement = readConstraint(label, sense, rhs, coef);
-
-            if( !returnStatement ) break;
-
-            constraint.push_back(Constraint(label, sense, rhs, coef, false, emptyList));
-         }
-      }
-   }
-
-   return returnStatement;
-}
-
-
-// Processes the relation to prove - either infeasibility or given range
-// Stores type of relation
-// Error if invalid verification type or bounds
-bool processRTP()
-{
-
-   cout << endl << "Processing RTP section..." << endl;
-
-   bool returnStatement = false;
-
-   string section;
-
-   certificateFile >> section;
-
-   // Checking section
-   if( section != "RTP" )
-   {
-      cerr << "RTP expected.   Read instead " << section << endl;
-   }
-   else
-   {
-      string relationToProveTypeStr;
-
-      certificateFile >> relationToProveTypeStr;
-
-
-      // Check verification type
-      if( relationToProveTypeStr == "infeas" )
-      {
-         relationToProveType = RelationToProveType::INFEAS;
-
-         cout << endl << "Need to verify infeasibility. " << endl;
-      }
-      else if( relationToProveTypeStr != "range" )
-      {
-         cerr << "RTP: unrecognized verification type: " << relationToProveTypeStr << endl;
-         goto TERMINATE;
-      }
-      else
-      {
-         relationToProveType = RelationToProveType::RANGE;
-
-         checkLower = checkUpper = false;
-
-         certificateFile >> lowerStr >> upperStr;
-
-         if( lowerStr != "-inf" )
-         {
-            checkLower = true;
-            lowerBound = mpq_class(lowerStr);
-         }
-
-         if( upperStr != "inf" )
-         {
-            checkUpper = true;
-            upperBound = mpq_class(upperStr);
-         }
-
-
-         // Check bounds
-         if( checkLower && checkUpper && (lowerBound > upperBound) )
-         {
-            cerr << "RTP: invalid bounds. " << endl;
-            goto TERMINATE;
-         }
-
-
-         // Stores relation as Constraint variable
-         if( isMin && checkLower )
-         {
-            relationToProve = Constraint("rtp", 1, lowerBound, objectiveCoefficients, false, emptyList);
-         }
-         else if( !isMin && checkUpper )
-         {
-            relationToProve = Constraint("rtp", -1, upperBound, objectiveCoefficients, false, emptyList);
-         }
-         else
-         {
-            returnStatement = true;
-            goto TERMINATE;
-         }
-
-         cout << "Need to verify optimal value range "
-                << (lowerStr == "-inf" ? "(" : "[")
-                << lowerStr << ", " << upperStr
-                << (upperStr == "inf" ? ")" : "]")
-                << "." << endl;
-
-      }
-      returnStatement = true;
-   }
-
-TERMINATE:
-   return returnStatement;
-
-}
-
-
-// Processes solutions to be verified
-// Checks constraints and bounds
-// Error if wrong format, type or if bounds violated by solution
-bool processSOL()
-{
-   cout << endl << "Processing SOL section..." << endl;
-
-   bool returnStatement = false;
-   mpq_class value;
-
-   string section, label;
-
-   certificateFile >> section;
-
-   // Check format
-   if( section != "SOL" )
-   {
-      cerr << "SOL expected.   Read instead " << section << endl;
-      return returnStatement;
-   }
-
-   certificateFile >> numberOfSolutions;
-
-   if( certificateFile.fail() )
-   {
-      cerr << "Failed to read number after SOL" << endl;
-   }
-   else if( numberOfSolutions < 0 )
-   {
-      cerr << "Invalid number after SOL: " << numberOfSolutions << endl;
-   }
-   else
-   {
-      auto satisfies = [] (Constraint &con, shared_ptr<SVectorGMP> &x)
-      {
-         bool returnStat = false;
 
-         mpq_class prod = scalarProduct(con.coefSVec(), x);
-
-         if( con.getSense() < 0 )
-         {
-            returnStat = (prod <= con.getRhs());
-         }
-         else if( con.getSense() > 0 )
-         {
-            returnStat = (prod >= con.getRhs());
-         }
-         else
-         {
-            returnStat = (con.getRhs() == prod);
-         }
+            check.violated = tbb::parallel_reduce(tbb::blocked_range<int>(0, numberOfConstraints), numberOfConstraints,
+               [&](const tbb::blocked_range<int> &range, int firstViolated)
+               {
+                  ArithmeticCounts &counts = arithmeticCounts.local();
 
-         return returnStat;
-      };
+                  for( int j = range.begin(); j < range.end() && j < firstViolated; ++j )
+                  {
+                     if( !satisfies(constraint[j], sol, counts) )
+                        firstViolated = j;
+                  }
+                  return firstViolated;
+               },
+               [](int a, int b) { return std::min(a, b); });
 
-      shared_ptr<SVectorGMP> solutionSpecified(make_shared<SVectorGMP>());
-      vector<mpq_class> sol(numberOfVariables);
+            check.objval = denseActivity(*objectiveCoefficients, sol, arithmeticCounts.local());
+         });
+      });
 
       for( int i = 0; i < numberOfSolutions; ++i )
       {
-         certificateFile >> label;
-         cout << "checking solution " << label << endl;
+         cout << "checking solution " << solutions[i].label << endl;
 
-         if( !readConstraintCoefficients(solutionSpecified) )
+         if( solutions[i].nonInteger >= 0 )
          {
-            cerr << "Failed to read solution." << endl;
+            cerr << "Noninteger value for integer variable "
+                 << solutions[i].nonInteger << endl;
             goto TERMINATE;
          }
-         else
+         else if( solutions[i].violated < numberOfConstraints )
          {
-            for( int j = 0; j < numberOfVariables; ++j )
-            {
-              sol[j] = 0;
-            }
-
-            // Check integrality constraints
-            for( auto it = solutionSpecified->begin(); it != solutionSpecified->end(); ++it )
-            {
-               if( isInt[it->first] && !isInteger(it->second) )
-               {
-                  cerr << "Noninteger value for integer variable "
-                       << it->first << endl;
-                  goto TERMINATE;
-               }
-              sol[it->first] = it->second;
-            }
-
-            for( int j = 0; j < numberOfConstraints; ++j )
-            {
-               if( !satisfies(constraint[i], solutionSpecified) )
-               {
-                  cerr << "Constraint " << i << " not satisfied." << endl;
-                  goto TERMINATE;
-               }
-            }
+            cerr << "Constraint " << solutions[i].violated << " not satisfied." << endl;
+            goto TERMINATE;
          }
 
-         value = scalarProduct(objectiveCoefficients , solutionSpecified);
+         value = solutions[i].objval;
 
          cout << "   objval = " << value << endl;
 
@@ -907,11 +695,16 @@ TERMINATE:
 }
 
 
-// Sequentially reads all derivations
-// Simultaniously checks everything except for LIN and RND
-bool seqCheck_Der()
+// Reads and checks all derivations in a pipeline of three stages
+// 1. windows of derivations are read in order, ASM and SOL derivations are checked directly
+// 2. the LIN and RND derivations of a window are checked in parallel
+// 3. in order of appearance, assumption lists are committed, UNS derivations are checked
+//    and constraints whose maximal reference index is verified are trashed
+// Reading the certificate thereby overlaps with checking the linear combinations
+bool ParallelCheck::processDER()
 {
-   cout << endl << "Reading DER section..." << endl;
+   cout << endl << "Processing DER section..." << endl;
+   stats.startPhase("DER");
 
    string section;
    certificateFile >> section;
@@ -941,14 +734,118 @@ bool seqCheck_Der()
       return true;
    }
 
+   cout << "Available threads: " << nthreads << endl;
+#ifdef VIPR_WITH_TBBMALLOC
+   cout << "Memory allocator: tbbmalloc, also for GMP" << endl;
+#endif
+   if( followTimeout >= 0 )
+      cout << "Following the certificate, waiting up to " << followTimeout << " seconds for new derivations" << endl;
+   if( numberOfShards > 1 )
+      cout << "Checking shard " << shardIndex << "/" << numberOfShards << " of the derivations" << endl;
+   if( windowSize > 0 )
+      cout << "Checking derivations in windows of " << windowSize << " linear combinations and unsplits" << endl;
+
+   if( resume && !readCheckpoint() )
+      return false;
+
+   stats.startProgress(numberOfReadDerivations);
+
+   gettimeofday( &lastCheckpoint, 0 );
+
+   limitedArena.execute([&]{
+      tbb::parallel_pipeline( maxLiveWindows,
+         // read the next window of derivations
+         tbb::make_filter<void, DerivationWindow*>( tbb::filter_mode::serial_in_order,
+            [&]( tbb::flow_control& fc ) -> DerivationWindow* {
+               if( checkFailed || derivationsEnded || numberOfReadDerivations >= numberOfDerivations )
+               {
+                  fc.stop();
+                  return nullptr;
+               }
+
+               DerivationWindow* window = new DerivationWindow;
+               if( !readDerivationWindow(*window) )
+               {
+                  window->success = false;
+                  checkFailed = true;
+               }
+               return window;
+            }
+         ) &
+         // check the linear combinations and unsplits of the window
+         tbb::make_filter<DerivationWindow*, DerivationWindow*>( tbb::filter_mode::parallel,
+            [&]( DerivationWindow* window ) {
+               if( window->success && !checkFailed )
+                  window->success = parCheck_Derivations(*window);
+               return window;
+            }
+         ) &
+         // commit the window in order of appearance
+         tbb::make_filter<DerivationWindow*, void>( tbb::filter_mode::serial_in_order,
+            [&]( DerivationWindow* window ) {
+               if( !window->success || checkFailed || !commitDerivationWindow(*window) )
+                  checkFailed = true;
+               delete window;
+            }
+         )
+      );
+   });
+
+   if( checkpointWriter.joinable() )
+      checkpointWriter.join();
+
+   if( checkFailed )
+      return false;
+
+   cout << "Checked " << numberOfCheckedLinCombs << " linear combinations and " << numberOfCheckedUnsplits
+        << " unsplits" << endl;
+   printThreadBusyTimes();
+   printArithmeticCounts();
+
+   const AssumptionSet &lastAssumptionList = constraint.back().getassumptionList();
+   if( lastAssumptionList != emptyList )
+   {
+      cout << "Final derived constraint undischarged assumptions:" << endl;
+      for( auto index : lastAssumptionList )
+         cout << index << ": " << constraint[index].label() << endl;
+      return false;
+   }
+
+   return true;
+}
+
+
+// Reads derivations until windowSize LIN, RND and UNS derivations are buffered or all derivations are read
+// Checks ASM and SOL derivations directly, LIN, RND and UNS derivations are stored in the window
+bool ParallelCheck::readDerivationWindow(DerivationWindow &window)
+{
    string label;
    int sense;
    mpq_class rhs;
 
-   for( int i = 0; i < numberOfDerivations; ++i )
+   window.startIdx = constraint.size();
+
+   for( ; numberOfReadDerivations < numberOfDerivations; ++numberOfReadDerivations )
+   {
+      if( windowSize > 0 && window.toCheck.size() + window.unsplits.size() >= windowSize )
+         break;
+
+      // in follow mode, the number of derivations is only an upper bound
+      if( followTimeout >= 0 && certificateFile.atEnd() )
       {
-         shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
+         if( numberOfReadDerivations == 0 )
+         {
+            cerr << "Certificate ended before the first derivation" << endl;
+            return false;
+         }
+
+         cout << "Certificate ended after " << numberOfReadDerivations << " of at most "
+              << numberOfDerivations << " derivations" << endl;
+         derivationsEnded = true;
+         break;
+      }
 
+      shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
 
       if( !readConstraint(label, sense, rhs, coef) )
       {
@@ -983,14 +880,14 @@ bool seqCheck_Der()
       // The constraint to be derived
       Constraint toDer(label, sense, rhs, coef, (derivationType == DerivationType::ASM), emptyList);
 
-      SVectorBool assumptionList;
-
       int newConIdx = constraint.size();
 
       switch( derivationType )
       {
          case DerivationType::ASM:
-            assumptionList[ newConIdx ] = true;
+            {
+               toDer.setassumptionList(AssumptionSet(newConIdx));
+            }
             certificateFile >> bracket;
 
             if( bracket != "}" )
@@ -1010,16 +907,14 @@ bool seqCheck_Der()
                   return false;
                }
 
-               // Merge assumptionLists
+               // constraints are trashed as soon as their maximal reference index is verified
                for( auto it = mult.begin(); it != mult.end(); ++it )
                {
-                  auto index = it->first;
-                  auto a = it->second;
-
-                  auto myassumptionList = constraint[index].getassumptionList();
-
-                  for( auto it2 = myassumptionList.begin(); it2 != myassumptionList.end(); ++it2 )
-                     assumptionList[it2->first] = true;
+                  if( isReleased(it->first, newConIdx) )
+                  {
+                     cerr << "Accessing trashed constraint: " << constraint[it->first].label() << endl;
+                     return false;
+                  }
                }
 
                certificateFile >> bracket;
@@ -1031,11 +926,20 @@ bool seqCheck_Der()
 
                // Store all information from certificate file
                toDer.coefSVec()->compactify();
-               toCheck.push_back(toDer);
-               indicesToChk.push_back(newConIdx);
-               correspondingDerType.push_back(derivationType);
-               correspondingSenses.push_back(senseDer);
-               mults.push_back(mult);
+               if( numberOfReadChecks++ % numberOfShards == (size_t) shardIndex )
+                  window.linCombsInShard.push_back(window.toCheck.size());
+               window.commits.push_back({(size_t) newConIdx, derivationType, window.toCheck.size(), -1, -1, -1, -1});
+               window.toCheck.push_back(toDer);
+               window.indicesToChk.push_back(newConIdx);
+               window.correspondingDerType.push_back(derivationType);
+               window.correspondingSenses.push_back(senseDer);
+               window.mults.push_back(mult);
+
+               // cost estimate: number of multipliers times the support size of the referenced constraints
+               size_t cost = 0;
+               for( auto it = mult.begin(); it != mult.end(); ++it )
+                  cost += constraint[it->first].coefSVec()->size();
+               window.costs.push_back(cost);
             }
             break;
          case DerivationType::UNS:
@@ -1062,18 +966,37 @@ bool seqCheck_Der()
                   return false;
                }
 
-               if( !canUnsplit(toDer, con1, asm1, con2, asm2, assumptionList) )
+               certificateFile >> bracket;
+               if( bracket != "}" )
                {
-                  cerr << label << ": unsplit failed" << endl;
+                  cerr << "Expecting } but read instead " << bracket << endl;
                   return false;
                }
 
-               certificateFile >> bracket;
-               if( bracket != "}" )
+               if( (asm1 < 0) || (asm1 >= newConIdx) || (asm2 < 0) || (asm2 >= newConIdx) )
                {
-                  cerr << "Expecting } but read instead " << bracket << endl;
+                  cerr << "asm1 or asm2 out of bounds: " << asm1 << " " << asm2 << endl;
                   return false;
                }
+
+               // the checks run in parallel, so the constraints must not be trashed before the window is verified
+               for( int index : { con1, con2, asm1, asm2 } )
+               {
+                  if( isReleased(index, newConIdx) )
+                  {
+                     cerr << "unsplitting trashed constraint: " << constraint[index].label() << endl;
+                     return false;
+                  }
+               }
+
+               // the unsplit is checked with the linear combinations, the assumption lists
+               // of con1 and con2 are only known on commit
+               if( numberOfReadChecks++ % numberOfShards == (size_t) shardIndex )
+                  window.unsplitsInShard.push_back(window.unsplits.size());
+               window.unsplits.push_back(window.commits.size());
+               window.unsplitCosts.push_back(constraint[con1].coefSVec()->size() + constraint[con2].coefSVec()->size()
+                     + constraint[asm1].coefSVec()->size() + toDer.coefSVec()->size());
+               window.commits.push_back({(size_t) newConIdx, derivationType, 0, con1, asm1, con2, asm2});
             }
             break;
          case DerivationType::SOL:
@@ -1111,698 +1034,558 @@ bool seqCheck_Der()
             return false;
             break;
       }
-      // Set the list of assumptions
-      toDer.setassumptionList(assumptionList);
 
       // Constraint hierarchy handling
       certificateFile >> refIdx;
       toDer.setMaxRefIdx(refIdx);
 
-      // Constraint trashing?
-
       constraint.push_back(toDer);
-      }
-   auto lastAssumptionList = constraint.back().getassumptionList();
-   if( lastAssumptionList != emptyList )
-   {
-      cout << "Final derived constraint undischarged assumptions:" << endl;
-      for( auto it = lastAssumptionList.begin(); it != lastAssumptionList.end(); ++it )
-      {
-         auto index = it->first;
 
-         cout << index << ": " << constraint[index].label() << endl;
-      }
-      return false;
+      ++derivationsOfType[derivationType];
+      numberOfNonzeros += coef->size();
    }
 
+   window.endIdx = constraint.size();
+   window.last = derivationsEnded || numberOfReadDerivations == numberOfDerivations;
+   window.endPos = certificateFile.tellg();
+   window.endReadChecks = numberOfReadChecks;
+
    return true;
 }
 
 
-// Calls parallelized checking of LIN and RND-type derivations
-// Processes final result
-bool parCheck_Der()
+// Checks the LIN, RND and UNS-type derivations of a window that belong to the shard of this process in parallel
+// Derivations are handed out most expensive first to one worker per thread, so that
+// a few huge linear combinations do not end up behind many small ones on the same thread
+bool ParallelCheck::parCheck_Derivations(DerivationWindow &window)
 {
-   tbb::task_arena limited_arena(nthreads);
-   bool returnStatement = true;
-   cout << "Checking Derivations ..." << endl;
-   cout << "Number of remaining linear combinations to check: "
-        << toCheck.size() << endl;
-   cout << "Available threads: " << nthreads << endl;
-   unsigned int grainsize = std::max(1,(int)((toCheck.size()/(2*nthreads))));
-   cout << "Grainsize set to " << grainsize << endl;
+   const size_t numberOfLinCombs = window.linCombsInShard.size();
+   const size_t numberToCheck = numberOfLinCombs + window.unsplitsInShard.size();
+   vector<size_t> order(numberToCheck);
+   std::atomic<size_t> next(0);
+   std::atomic<bool> success(true);
 
-   limited_arena.execute([&]{
-      tbb::parallel_for( tbb::blocked_range<size_t>(0, toCheck.size(), grainsize),
-                           [&](tbb::blocked_range<size_t> range)
-      {
-         for( size_t index = range.begin(); index < range.end(); ++index)
-         {
-            if( !chkLinearCombinations(index) )
-            {
-               tbb::task::current_context()->cancel_group_execution();
-               returnStatement = false;
-            }
-         }
-      }, tbb::simple_partitioner());
-   });
+   // linear combinations come first, followed by the unsplits
+   auto _cost = [&](size_t i) {
+      return (i < numberOfLinCombs) ? window.costs[window.linCombsInShard[i]]
+         : window.unsplitCosts[window.unsplitsInShard[i - numberOfLinCombs]];
+   };
 
-   if(!returnStatement)
-      return false;
+   for( size_t i = 0; i < numberToCheck; ++i )
+      order[i] = i;
 
-   // Final result
-   if( relationToProveType == RelationToProveType::INFEAS )
-   {
-      if( constraint.back().isFalsehood() )
-      {
-         cout << "Infeasibility verified." << endl;
-         returnStatement = true;
-      }
-      else
-         cout << "Failed to verify infeasibility." << endl;
-   }
-   else if( (isMin && checkLower) || (!isMin && checkUpper) )
+   std::stable_sort(order.begin(), order.end(),
+         [&](size_t i, size_t j) { return _cost(i) > _cost(j); });
+
+   auto worker = [&]()
    {
-      if( relationToProve.isTautology() )
+      struct timeval start, end;
+      gettimeofday( &start, 0 );
+
+      for( size_t k = next++; k < numberToCheck && success && !checkFailed; k = next++ )
       {
-         cout << "RTP is a tautology." << endl;
-         returnStatement = true;
+         size_t i = order[k];
+
+         if( i < numberOfLinCombs ? !chkLinearCombinations(window, window.linCombsInShard[i])
+               : !chkUnsplit(window, window.unsplitsInShard[i - numberOfLinCombs]) )
+            success = false;
       }
-      else if( !constraint.back().dominates(relationToProve) )
-      {
-         if( isMin )
-            cout << "Failed to derive lower bound." << endl;
-         else
-            cout << "Failed to derive upper bound." << endl;
-         cout << "Proved: " << endl;
-         constraint.back().print();
-         cout << "Instead of: " << endl;
-         relationToProve.print();
-   }
-      else
-      {
-         if( numberOfSolutions ) {
-            cout << "Best objval over all solutions: " << bestObjectiveValue << endl;
-         }
 
-         cout << "Successfully verified optimal value range "
-                << (lowerStr == "-inf" ? "(" : "[")
-                << lowerStr << ", " << upperStr
-                << (upperStr == "inf" ? ")" : "]")
-                << "." << endl;
+      gettimeofday( &end, 0 );
+      int threadIndex = tbb::this_task_arena::current_thread_index();
+      if( threadIndex >= 0 && threadIndex < (int) threadBusyTime.size() )
+         threadBusyTime[threadIndex] += getTimeSecs(start, end);
+   };
 
-         returnStatement = true;
-      }
-   }
-   return returnStatement;
+   tbb::task_group workers;
+   size_t numberOfWorkers = std::min((size_t) nthreads, numberToCheck);
+
+   for( size_t w = 1; w < numberOfWorkers; ++w )
+      workers.run(worker);
+   if( numberOfWorkers > 0 )
+      worker();
+   workers.wait();
+
+   return success;
 }
 
 
-// Checking of LIN and RND-type derivations
-// Checks linear combinations
-// Checks derived constraint against the given
-bool chkLinearCombinations(size_t i)
+// Prints how often exact arithmetic fell back from 64-bit integers to GMP
+void printArithmeticCounts()
 {
-   Constraint check = toCheck[i];
-   size_t newConIdx = indicesToChk[i];
-   string label = check.label();
-   SVectorGMP mult = mults[i];
-   SVectorBool assumptionList;
-   shared_ptr<SVectorGMP> coefDer(make_shared<SVectorGMP>());
-   mpq_class rhsDer;
-   int senseDer = correspondingSenses[i];
-   DerivationType derivationType = correspondingDerType[i];
-
-   if( !readLinComb( rhsDer, coefDer, newConIdx, assumptionList, mult ) )
+   ArithmeticCounts total;
+   for( auto &counts : arithmeticCounts )
    {
-      return false;
+      total.fast += counts.fast;
+      total.fallback += counts.fallback;
    }
 
-   assert(!check.isAssumption());
-   Constraint derived("", senseDer, rhsDer, coefDer, false,
-         check.getassumptionList());
-
-   if( derivationType == DerivationType::RND )   // round the coefficients
-      if( !derived.round() )
-         return false;
+   cout << "Exact arithmetic: " << total.fast << " operations on 64-bit integers, "
+        << total.fallback << " fallbacks to GMP" << endl;
+}
 
-   // check the from reason derived constraint against the given
-   if( !derived.dominates(check) )
-   {
-      cout << "Failed to derive constraint " << label << endl;
-      check.print();
 
-      cout << "Derived instead " << endl;
-      derived.print();
+// Writes the statistics of the check to statsFileName, one file per process with MPI
+void ParallelCheck::writeStats(bool verified)
+{
+   ArithmeticCounts total;
+   string fileName = statsFileName;
 
-      cout << "difference: " << endl;
-      (derived - check).print();
-      return false;
+   for( auto &counts : arithmeticCounts )
+   {
+      total.fast += counts.fast;
+      total.fallback += counts.fallback;
    }
-   return true;
-}
 
+   stats.endPhase();
+   // a single shard has not checked the whole certificate
+   stats.setInfo("result", !verified ? "failed" : (numberOfShards > 1 ? "shard_verified" : "verified"));
+   stats.setInfo("shard", std::to_string(shardIndex) + "/" + std::to_string(numberOfShards));
+   stats.set("threads", nthreads);
+   stats.set("variables", numberOfVariables);
+   stats.set("constraints", numberOfConstraints);
+   stats.set("derivations", numberOfReadDerivations);
+   stats.set("derivations_asm", derivationsOfType[DerivationType::ASM]);
+   stats.set("derivations_lin", derivationsOfType[DerivationType::LIN]);
+   stats.set("derivations_rnd", derivationsOfType[DerivationType::RND]);
+   stats.set("derivations_uns", derivationsOfType[DerivationType::UNS]);
+   stats.set("derivations_sol", derivationsOfType[DerivationType::SOL]);
+   stats.set("nonzeros", numberOfNonzeros);
+   stats.set("multipliers", numberOfMultipliers);
+   stats.set("checked_linear_combinations", numberOfCheckedLinCombs);
+   stats.set("checked_unsplits", numberOfCheckedUnsplits);
+   stats.set("arithmetic_fast", total.fast);
+   stats.set("arithmetic_gmp_fallbacks", total.fallback);
+
+#ifdef VIPR_WITH_MPI
+   if( mpiSize > 1 )
+      fileName += "." + std::to_string(mpiRank);
+#endif
 
-// Classes and Functions
-inline mpq_class floor(const mpq_class &q)
-{
-   mpz_t z;
-   mpq_class result;
-   mpz_init (z);
-   mpz_fdiv_q(z, q.get_num_mpz_t(), q.get_den_mpz_t()); // Divide numerator by denominator and floor the result
-   result = mpz_class(z);
-   mpz_clear (z);
-   return result;
+   stats.writeJSON(fileName.c_str(), cerr);
 }
 
 
-inline mpq_class ceil(const mpq_class &q)
+// Prints the time each thread spent checking linear combinations
+void printThreadBusyTimes()
 {
-   mpz_t z;
-   mpq_class result;
-   mpz_init (z);
-   mpz_cdiv_q(z, q.get_num_mpz_t(), q.get_den_mpz_t()); // Divide numerator by denominator and ceil the result
-   result = mpz_class(z);
-   mpz_clear (z);
-   return result;
-}
+   double maxBusyTime = 0.0;
+   double totalBusyTime = 0.0;
 
+   cout << "Busy time per thread (seconds):";
+   for( size_t t = 0; t < threadBusyTime.size(); ++t )
+   {
+      cout << " " << threadBusyTime[t];
+      maxBusyTime = std::max(maxBusyTime, threadBusyTime[t]);
+      totalBusyTime += threadBusyTime[t];
+   }
+   cout << endl;
 
-bool isInteger(const mpq_class &q)
-{
-   return (q == floor(q));
+   if( maxBusyTime > 0 )
+      cout << "Load balance (average/maximal busy time): "
+           << totalBusyTime / (threadBusyTime.size() * maxBusyTime) << endl;
 }
 
 
-bool readLinComb( mpq_class &rhs, shared_ptr<SVectorGMP> coefficients,
-                  int currentConstraintIndex,SVectorBool &assumptionList, SVectorGMP &mult)
+// Sets the assumption lists of all LIN, RND and UNS derivations of a window
+// Must be called in order of appearance, afterwards all constraints before window.endIdx are verified
+bool ParallelCheck::commitDerivationWindow(DerivationWindow &window)
 {
-   bool returnStatement = true;
-
-   rhs = 0;
-   coefficients->clear();
-   assumptionList.clear();
+   const int lastConIdx = window.last ? window.endIdx - 1 : numberOfConstraints + numberOfDerivations - 1;
 
-   for( auto it = mult.begin(); it != mult.end(); ++it )
+   for( auto &commit : window.commits )
    {
-      auto index = it->first;
-      auto a = it->second;
-
-      const Constraint &con = constraint[index];
+      Constraint &toDer = constraint[commit.conIdx];
+      AssumptionSet assumptionList;
 
-      if( con.isTrashed() )
+      if( commit.type == DerivationType::UNS )
       {
-         cerr << "Accessing trashed constraint: " << con.label() << endl;
-         returnStatement = false;
+         // the unsplit discharges the two branch assumptions
+         assumptionList = constraint[commit.con1].getassumptionList().without(commit.asm1);
+         assumptionList.merge(constraint[commit.con2].getassumptionList().without(commit.asm2));
+
+#ifdef MORE_DEBUG_OUTPUT
+         if (!constraint[commit.con1].hasAsm(commit.asm1))
+            cout << "Warning: " << commit.asm1 << " not present in unsplit" << endl;
+         if (!constraint[commit.con2].hasAsm(commit.asm2))
+            cout << "Warning: " << commit.asm2 << " not present in unsplit" << endl;
+#endif
       }
       else
       {
-         shared_ptr<SVectorGMP> c = constraint[index].coefSVec();
-
-         for( auto itr = c->begin(); itr != c->end(); ++itr )
-            (*coefficients)[ itr->first ] += a * itr->second;
+         // Merge assumptionLists
+         SVectorGMP &mult = window.mults[commit.linCombIdx];
 
-         rhs += a * constraint[index].getRhs();
+         for( auto it = mult.begin(); it != mult.end(); ++it )
+            assumptionList.merge(constraint[it->first].getassumptionList());
       }
-   }
 
-   return returnStatement;
-}
+      // Set the list of assumptions
+      toDer.setassumptionList(assumptionList);
+   }
 
+   numberOfCheckedLinCombs += window.linCombsInShard.size();
+   numberOfCheckedUnsplits += window.unsplitsInShard.size();
 
-bool readMultipliers(int &sense, SVectorGMP &mult)
-{
+   // Constraint trashing; never trash last constraint
+   for( int idx = window.startIdx; idx < window.endIdx && idx < lastConIdx; ++idx )
+   {
+      int refIdx = constraint[idx].getMaxRefIdx();
 
-   int k;
-   bool returnStatement = true;
+      if( refIdx >= 0 )
+         trashQueue.push(std::make_pair(refIdx, idx));
+   }
 
-   sense = 0;
-   mult.clear();
+   trashConstraints(window.endIdx);
 
-   certificateFile >> k;
+   if( followTimeout >= 0 )
+      cout << "Verified " << window.endIdx - numberOfConstraints << " derivations" << endl;
+   else
+      stats.progress(window.endIdx - numberOfConstraints, numberOfDerivations, "derivations", cout);
 
-   for( auto j = 0; j < k; ++j )
+   if( checkpointFileName != nullptr && !window.last )
    {
-      mpq_class a;
-      int index;
-
-      certificateFile >> index >> a;
-
-      if( a == 0 ) continue; // ignore 0 multiplier
-
-      mult[index] = a;
+      struct timeval now;
+      gettimeofday( &now, 0 );
 
-      if( sense == 0 )
+      if( getTimeSecs(lastCheckpoint, now) >= checkpointInterval )
       {
-         sense = constraint[index].getSense() * sgn(a);
-      }
-      else
-      {
-         int tmp = constraint[index].getSense() * sgn(a);
-         if( tmp != 0 && sense != tmp )
-         {
-            cerr << "Coefficient has wrong sign for index " << index << endl;
-            returnStatement = false;
-            goto TERMINATE;
-         }
+         writeCheckpoint(window);
+         lastCheckpoint = now;
       }
    }
 
-TERMINATE:
-   return returnStatement;
+   return true;
 }
 
 
-// Read and store constraints
-bool readConstraintCoefficients(shared_ptr<SVectorGMP> &coefficients)
+// Trashes all constraints whose maximal reference index is smaller than numberOfVerified,
+// i.e., constraints that are not referenced by any derivation that still has to be verified
+void ParallelCheck::trashConstraints(const int numberOfVerified)
 {
-   auto returnStatement = false;
-   int k = 0;
-   string tmp;
-
-   coefficients->clear();
-   certificateFile >> tmp;
-
-   if( tmp == "OBJ" ) // case that constraint = objective function
+   while( !trashQueue.empty() && trashQueue.top().first < numberOfVerified )
    {
-      coefficients = objectiveCoefficients;
-      returnStatement = true;
+      constraint[trashQueue.top().second].trash();
+      trashQueue.pop();
    }
-   else
-   {
-      k = atoi(tmp.c_str());
-
-      if( certificateFile.fail() )
-      {
-         cerr << "Error reading number of elements " << endl;
-         goto TERMINATE;
-      }
-      else
-      {
-         for( int j = 0; j < k; j++ )
-         {
-            int index;
-            mpq_class a;
-
-            certificateFile >> index >> a;
-            if( certificateFile.fail() )
-            {
-               cerr << "Error reading integer-rational pair " << endl;
-               goto TERMINATE;
-            }
-            else if( index < 0 || index >= numberOfVariables )
-            {
-               cerr << "Index out of bounds: " << index << endl;
-               goto TERMINATE;
-            }
-            (*coefficients)[index] = a;
-         }
-         returnStatement = true;
-      }
-   }
-
-   coefficients->compactify();
-
-TERMINATE:
-   return returnStatement;
 }
 
 
-bool readConstraint(string &label, int &sense, mpq_class &rhs, shared_ptr<SVectorGMP> &coefficients)
+// Saves the state after a committed window: the position in the certificate, the constraints that are
+// not trashed with their assumption lists and the statistics; constraints of the CON section are read
+// again on resume, so only their indices are stored
+// The text is assembled here and written to a temporary file on a separate thread, which is renamed
+// to the checkpoint file once it is complete
+void ParallelCheck::writeCheckpoint(const DerivationWindow &window)
 {
+   std::ostringstream text;
+   vector<int> live;
+
+   for( int idx = 0; idx < window.endIdx; ++idx )
+      if( !constraint[idx].isTrashed() )
+         live.push_back(idx);
+
+   text << "VIPR_CHECKPOINT 1\n"
+        << "derivations " << numberOfDerivations << " shard " << shardIndex << " " << numberOfShards << "\n"
+        << "position " << (long long) window.endPos << " read " << window.endIdx - numberOfConstraints
+        << " " << window.endReadChecks << "\n"
+        << "checked " << numberOfCheckedLinCombs << " " << numberOfCheckedUnsplits << "\n"
+        << "best " << bestObjectiveValue << "\n"
+        << "live " << live.size() << "\n";
+
+   for( int idx : live )
+   {
+      const Constraint &con = constraint[idx];
 
-   auto returnStatement = false;
-   char senseChar;
-
-   certificateFile >> label >> senseChar;
+      text << idx << " " << con.getMaxRefIdx();
 
-   if( !certificateFile.fail() )
-   {
-      if( senseChar == 'E' )
-         sense = 0;
-      else if( senseChar == 'L' )
-         sense = -1;
-      else if( senseChar == 'G' )
-         sense = 1;
-      else
+      if( idx >= numberOfConstraints )
       {
-        cerr << "Unknown sense for " << label << ": " << senseChar << endl;
-        goto TERMINATE;
+         const SVectorGMP &coef = *con.coefSVec();
+
+         text << " " << con.isAssumption() << " " << con.label() << " " << con.getSense() << " " << con.getRhs()
+              << " " << coef.size();
+         for( auto it = coef.begin(); it != coef.end(); ++it )
+            text << " " << it->first << " " << it->second;
       }
 
-      certificateFile >> rhs;
+      const AssumptionSet &assumptionList = con.getassumptionList();
+      text << " " << assumptionList.size();
+      for( auto index : assumptionList )
+         text << " " << index;
+      text << "\n";
+   }
+
+   if( checkpointWriter.joinable() )
+      checkpointWriter.join();
 
-      if( !certificateFile.fail() )
-         returnStatement = readConstraintCoefficients(coefficients);
+   checkpointWriter = std::thread([contents = text.str()]() {
+      string tmpName = string(checkpointFileName) + ".tmp";
+      std::ofstream out(tmpName, std::ios::binary);
 
-      if( !returnStatement ) cerr << label <<   ": Error reading constraint " << endl;
-   }
+      out << contents;
+      out.close();
 
-TERMINATE:
-   return returnStatement;
+      if( !out || std::rename(tmpName.c_str(), checkpointFileName) != 0 )
+         cerr << "Failed to write checkpoint " << checkpointFileName << endl;
+   });
+
+   cout << "Checkpoint after " << window.endIdx - numberOfConstraints << " derivations" << endl;
 }
 
 
-// con1 and con2 must be inequalities for an integer disjunction
-// e.g. mx <= d and mx >= d+1 such that the variables indexed by
-// the support of m are integers.   The function checks this.
-// a1 and a2 are assumptions.
-bool canUnsplit(  Constraint &toDer, const int con1, const int a1,
-                  const int con2, const int a2, SVectorBool &assumptionList)
+// Restores the state saved by writeCheckpoint and continues reading the certificate after the
+// last committed window; without a checkpoint file, the check starts with the first derivation
+bool ParallelCheck::readCheckpoint()
 {
+   ifstream in(checkpointFileName);
+   string tmpStr;
+   int version, derivations, shard, shards, read;
+   long long position;
+   size_t readChecks, checkedLinCombs, checkedUnsplits, numberOfLive;
+   mpq_class best;
 
-   bool returnStatement = false;
+   if( !in )
+   {
+      cout << "No checkpoint " << checkpointFileName << ", starting with the first derivation" << endl;
+      return true;
+   }
 
-   const Constraint &c1 = constraint[con1];
-   const Constraint &c2 = constraint[con2];
+   in >> tmpStr >> version;
+   if( tmpStr != "VIPR_CHECKPOINT" || version != 1 )
+   {
+      cerr << checkpointFileName << " is not a checkpoint of viprchk_parallel" << endl;
+      return false;
+   }
 
-   const Constraint &branchAsm1 = constraint[a1];
-   const Constraint &branchAsm2 = constraint[a2];
+   in >> tmpStr >> derivations >> tmpStr >> shard >> shards
+      >> tmpStr >> position >> tmpStr >> read >> readChecks
+      >> tmpStr >> checkedLinCombs >> checkedUnsplits
+      >> tmpStr >> best >> tmpStr >> numberOfLive;
 
-   if( c1.isTrashed() )
+   if( !in || derivations != numberOfDerivations || best != bestObjectiveValue || read > numberOfDerivations )
    {
-      cerr << "unsplitting trashed constraint: " << c1.label() << endl;
-      goto TERMINATE;
+      cerr << "Checkpoint " << checkpointFileName << " does not belong to this certificate" << endl;
+      return false;
    }
-   else if( c2.isTrashed() )
+
+   if( shard != shardIndex || shards != numberOfShards )
    {
-      cerr << "unsplitting trashed constraint: " << c2.label() << endl;
-      goto TERMINATE;
+      cerr << "Checkpoint " << checkpointFileName << " was written for shard " << shard << "/" << shards << endl;
+      return false;
    }
 
-   if( c1.dominates(toDer) && c2.dominates(toDer) )
+   if( !certificateFile.canSeek() )
    {
-      SVectorGMP asm1Coef, asm2Coef;
-      mpq_class asm1Rhs, asm2Rhs;
-
-      SVectorBool asm1 = c1.getassumptionList();
-      SVectorBool asm2 = c2.getassumptionList();
-
-#ifdef MORE_DEBUG_OUTPUT
-      // remove the indices involved in unsplitting
-      if (asm1.find(a1) == asm1.end())
-         cout << "Warning: " << a1 << " not present in unsplit" << endl;
-      if (asm2.find(a2) == asm2.end())
-         cout << "Warning: " << a2 << " not present in unsplit" << endl;
-#endif
-
-      asm1.erase(a1);
-      asm2.erase(a2);
-
-      assumptionList.clear();
-      assumptionList = asm1;
+      cerr << "Resuming needs a certificate file that can be read at random, not a pipe or compressed file" << endl;
+      return false;
+   }
 
-#ifdef MORE_DEBUG_OUTPUT
-      cout << "asm1: ";
-      for( auto it = asm1.begin(); it != asm1.end(); ++it ) {
-         cout << it->first << " ";
-      }
-      cout << endl;
+   const int endIdx = numberOfConstraints + read;
+   const int lastConIdx = numberOfConstraints + numberOfDerivations - 1;
+   AssumptionSet previousList;
+   int idx = -1;
 
-      cout << "asm2: ";
-      for( auto it = asm2.begin(); it != asm2.end(); ++it ) {
-         cout << it->first << " ";
-      }
-      cout << endl;
-#endif
+   for( size_t k = 0; k < numberOfLive; ++k )
+   {
+      int nextIdx, refIdx;
+      size_t numberOfAssumptions;
 
-      for( auto it = asm2.begin(); it != asm2.end(); ++it ) {
-         if( assumptionList.find(it->first) != assumptionList.end() ) {
-            assumptionList[it->first] = true;
-         }
-      }
+      in >> nextIdx >> refIdx;
 
-      if( branchAsm1.isTrashed() )
+      if( !in || nextIdx <= idx || nextIdx >= endIdx )
       {
-         cerr << "accessing trashed constraint: " << branchAsm1.label() << endl;
-         goto TERMINATE;
-      }
-      else if( c2.isTrashed() )
-      {
-         cerr << "accessing trashed constraint: " << c2.label() << endl;
-         goto TERMINATE;
+         cerr << "Checkpoint " << checkpointFileName << " is incomplete" << endl;
+         return false;
       }
 
-
-      // the constraints must have opposite senses
-      if( -1 != branchAsm1.getSense() * branchAsm2.getSense() )
+      // constraints between two live ones have been trashed
+      while( ++idx < nextIdx )
       {
-         cerr << "canUnsplit: Failed sense requirement for assumptions" << endl;
-         cerr << "branchAsm1 sense:: " << branchAsm1.getSense() << endl;
-         cerr << "branchAsm2 sense:: " << branchAsm2.getSense() << endl;
-         goto TERMINATE;
+         if( idx < numberOfConstraints )
+            constraint[idx].trash();
+         else
+         {
+            constraint.push_back(Constraint());
+            constraint.back().trash();
+         }
       }
-      else
-      {
 
-         // check if disjunction gives a tautology with respect to the variable
-         // integrality requirements
-         bool stat = true;
-         if( branchAsm1.getSense() < 0 )
-            stat = ((branchAsm1.getRhs() + 1) == branchAsm2.getRhs());
-         else // must be > 0
-            stat = (branchAsm1.getRhs() == (branchAsm2.getRhs() + 1));
-
-         if( !stat ) {
-            cerr << branchAsm1.label() << " and " << branchAsm2.label()
-                 << " do not form a tautology" << endl;
-            goto TERMINATE;
-         };
+      if( idx >= numberOfConstraints )
+      {
+         bool isAssumption;
+         string label;
+         int sense;
+         mpq_class rhs;
+         size_t size;
+         shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
 
-         shared_ptr<SVectorGMP> c1ptr = branchAsm1.coefSVec();
-         shared_ptr<SVectorGMP> c2ptr = branchAsm2.coefSVec();
-         if( (c1ptr == c2ptr) || (*c1ptr == *c2ptr) ) // coefSVec can both point to objectiveCoefficients
+         in >> isAssumption >> label >> sense >> rhs >> size;
+         for( size_t j = 0; j < size && in; ++j )
          {
+            int index;
+            mpq_class value;
 
-            for( auto it = c1ptr->begin(); it != c1ptr->end(); ++it )
-            {
-               if( !isInt[it->first] )
-               {
-                  cerr << "canUnsplit: noninteger variable index " << it->first
-                         << endl;
-                  goto TERMINATE;
-               }
-               else if( !isInteger(it->second) )
-               {
-                  cerr << "canUnsplit: noninteger coefficient for index "
-                         << it->first << endl;
-                  goto TERMINATE;
-               }
-            }
-         }
-         else
-         {
-            cerr << "canUnsplit: coefs of asm constraints differ" << endl;
-            goto TERMINATE;
+            in >> index >> value;
+            coef->push_back(index, value);
          }
-         returnStatement = true;
-      }
-   }
 
-TERMINATE:
-   return returnStatement;
-}
+         constraint.push_back(Constraint(label, sense, rhs, coef, isAssumption, emptyList));
+      }
 
+      vector<int> assumptions;
+      in >> numberOfAssumptions;
+      for( size_t j = 0; j < numberOfAssumptions && in; ++j )
+      {
+         int index;
+         in >> index;
+         assumptions.push_back(index);
+      }
 
-// SVectorGMP methods
-bool SVectorGMP::operator!=(SVectorGMP &other)
-{
-   bool returnStatement = false;
+      // consecutive constraints often share their assumptions
+      AssumptionSet assumptionList(std::move(assumptions));
+      if( assumptionList == previousList )
+         assumptionList = previousList;
+      previousList = assumptionList;
 
-   SVectorGMP &cf1 = *this;
-   SVectorGMP &cf2 = other;
+      constraint[idx].setassumptionList(assumptionList);
+      constraint[idx].setMaxRefIdx(refIdx);
 
-   // get rid of all zero entries
-   cf1.compactify();
-   cf2.compactify();
+      if( refIdx >= 0 && idx < lastConIdx )
+         trashQueue.push(std::make_pair(refIdx, idx));
+   }
 
-   if( cf1.size() != cf2.size() )
+   if( !in )
    {
-      returnStatement = true;
+      cerr << "Checkpoint " << checkpointFileName << " is incomplete" << endl;
+      return false;
    }
-   else
+
+   while( ++idx < endIdx )
    {
-      for( auto it1 = cf1.begin(); it1 != cf1.end(); ++it1 )
+      if( idx < numberOfConstraints )
+         constraint[idx].trash();
+      else
       {
-         auto it2 = cf2.find(it1->first);
-         if( it2 == cf2.end() || it2->second != it1->second )
-         {
-            returnStatement = true;
-            break;
-         }
+         constraint.push_back(Constraint());
+         constraint.back().trash();
       }
    }
 
-   return returnStatement;
-}
-
-
-// use non-sparse vector for v to reduce lookup time
-mpq_class scalarProduct(shared_ptr<SVectorGMP> u, shared_ptr<SVectorGMP> v)
-{
-   mpq_class product = 0;
-
-   for( auto it = u->begin(); it != u->end(); ++it )
+   certificateFile.seekg(position);
+   if( certificateFile.fail() )
    {
-      auto it2 = v->find(it->first);
-      if( it2 != v->end() )
-         product += it->second * it2->second;
+      cerr << "Failed to continue at position " << position << " of the certificate" << endl;
+      return false;
    }
 
-   return product;
-}
-
-
-// Constraint methods
-bool Constraint::round()
-{
-   bool returnStatement = true;
-
-   for( auto it = _coefficients->begin(); it != _coefficients->end(); ++it )
-   {
-      auto j = it->first;
-      auto a = it->second;
-
-      if( isInt[j] )
-      {   // needs to be an integer variable
-         if( !isInteger(a) )
-         {
-            cerr << "Coefficient of integer variable with index "
-                 << j << " is not an integer" << endl;
-            returnStatement = false;
-            goto TERMINATE;
-         }
-      }
-   }
+   numberOfReadDerivations = read;
+   numberOfReadChecks = readChecks;
+   numberOfCheckedLinCombs = checkedLinCombs;
+   numberOfCheckedUnsplits = checkedUnsplits;
 
-   if( getSense() < 0 ) // round down
-      _rhs = floor(_rhs);
-   else if( getSense() > 0 ) // round up
-      _rhs = ceil(_rhs);
+   cout << "Resuming after " << read << " derivations from checkpoint " << checkpointFileName << endl;
 
-TERMINATE:
-   return returnStatement;
+   return true;
 }
 
 
-bool Constraint::_isFalsehood()
+// Prints that the result is verified
+// A single shard has not checked all derivations, so it only reports its own part
+static void printVerified(const string &verdict)
 {
-   bool returnStatement = false;
-
-   if( _coefficients->size() == 0 )
-   {
-      if( ((getSense() <= 0) && (_rhs < 0)) || ((getSense() >= 0) && (_rhs > 0)) )
-         returnStatement = true;
-   }
-
-   return returnStatement;
+   if( numberOfShards > 1 )
+      cout << "Shard " << shardIndex << "/" << numberOfShards << " checked; the certificate is verified only if all "
+           << numberOfShards << " shards are" << endl;
+   else
+      cout << verdict << endl;
 }
 
 
-bool Constraint::dominates(Constraint &other) const
+// Processes final result
+bool ParallelCheck::checkResult()
 {
    bool returnStatement = false;
 
-   if( this->isFalsehood() )
+   // Final result
+   if( relationToProveType == RelationToProveType::INFEAS )
    {
-      returnStatement = true;
+      if( constraint.back().isFalsehood() )
+      {
+         printVerified("Infeasibility verified.");
+         returnStatement = true;
+      }
+      else
+         cout << "Failed to verify infeasibility." << endl;
    }
-   else if( *(this->_coefficients) == *(other._coefficients) )  // force object comparison
+   else if( (isMin && checkLower) || (!isMin && checkUpper) )
    {
-      if( (other.getSense() > 0 && this->getSense() >= 0 &&
-             this->_rhs >= other._rhs)
-         || (other.getSense() < 0 && this->getSense() <= 0 &&
-             this->_rhs <= other._rhs)
-         || (other.getSense() == 0 && this->getSense() == 0 &&
-             this->_rhs == other._rhs) )
+      if( relationToProve.isTautology() )
       {
+         printVerified("RTP is a tautology.");
          returnStatement = true;
       }
+      else if( !constraint.back().dominates(relationToProve) )
+      {
+         if( isMin )
+            cout << "Failed to derive lower bound." << endl;
+         else
+            cout << "Failed to derive upper bound." << endl;
+         cout << "Proved: " << endl;
+         constraint.back().print(cout, variable);
+         cout << "Instead of: " << endl;
+         relationToProve.print(cout, variable);
    }
+      else
+      {
+         if( numberOfSolutions ) {
+            cout << "Best objval over all solutions: " << bestObjectiveValue << endl;
+         }
 
-   return returnStatement;
-}
-
-
-bool Constraint::isTautology() {
-   bool returnStatement = false;
+         printVerified("Successfully verified optimal value range "
+                       + string(lowerStr == "-inf" ? "(" : "[")
+                       + lowerStr + ", " + upperStr
+                       + (upperStr == "inf" ? ")" : "]") + ".");
 
-   if( _coefficients->size() == 0 )
-   {
-      if( ((getSense() == 0) && (0 == _rhs))
-         || ((getSense() < 0) && (_rhs >= 0))
-         || ((getSense() > 0) && (_rhs <= 0)) )
-      {
          returnStatement = true;
       }
    }
+   else
+      returnStatement = true;
+
    return returnStatement;
 }
 
 
-void Constraint::print() {
-   bool first = true;
-   mpq_class myCoefficient;
-   cout.precision(std::numeric_limits<double>::max_digits10);
-
-   int count = 0;
-
-   if( _isAssumption )
-      cout << "Is assumption: ";
-
-   for( auto it = _coefficients->begin(); it != _coefficients->end(); ++it )
-   {
-      auto index = it->first;
-      auto a = it->second;
+// Checking of LIN and RND-type derivations
+// Checks linear combinations
+// Checks derived constraint against the given
+bool ParallelCheck::chkLinearCombinations(DerivationWindow &window, size_t i)
+{
+   assert(!window.toCheck[i].isAssumption());
 
-      myCoefficient = abs(a);
+   return checkLinComb(window.toCheck[i], window.correspondingDerType[i], window.correspondingSenses[i],
+                       window.mults[i], accumulators.local(), arithmeticCounts.local());
+}
 
-      if( a > 0 )
-      {
-         if( !first ) cout << " + ";
-         cout << (myCoefficient == 1 ? string("") : string(myCoefficient.get_str()) + " ")
-              << "( " << a.get_d() << " ) "
-              << variable[index];
-         ++count;
-         first = false;
-      }
-      else if( a < 0 )
-      {
-         cout << " - "
-                << (myCoefficient == 1 ? string("") : string(myCoefficient.get_str()) + " ")
-                << "( " << a.get_d() << " ) "
-                << variable[index];
-         first = false;
-         ++count;
-      }
 
-      if( (count+1) % 4 == 0 ) cout << endl;
-   }
 
-   if( first ) // coefficients are all zero
-   {
-      cout << "0";
-   }
+// con1 and con2 must be inequalities for an integer disjunction
+// e.g. mx <= d and mx >= d+1 such that the variables indexed by
+// the support of m are integers.   The function checks this.
+// a1 and a2 are assumptions.
+// Checking of UNS-type derivations, the assumption lists are set on commit
+bool ParallelCheck::chkUnsplit(DerivationWindow &window, size_t i)
+{
+   const PendingCommit &commit = window.commits[window.unsplits[i]];
+   const Constraint &toDer = constraint[commit.conIdx];
 
-   switch( _sense )
+   if( !canUnsplit(toDer, (int) commit.conIdx, commit.con1, commit.asm1, commit.con2, commit.asm2) )
    {
-      case -1: cout << " <= "; break;
-      case 1: cout << " >= "; break;
-      case 0: cout << " = "; break;
-      default : assert(false);
+      cerr << toDer.label() << ": unsplit failed" << endl;
+      return false;
    }
-   cout << _rhs << " ( " << _rhs.get_d() << " )" << endl;
 
-#ifndef NDEBUG
-   if( !_isAssumption )
-   {
-      cout << " -- assumptions: " << endl;
-      for( auto it = _assumptionList.begin(); it != _assumptionList.end(); ++it )
-      {
-         auto index = it->first;
-         cout << "   "<< it->first << ": " << constraint[index].label() << endl;
-      }
-      cout << endl;
-   }
-#endif
+   return true;
 }
+
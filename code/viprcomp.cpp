@@ -28,16 +28,27 @@
 #include <vector>
 #include <map>
 #include <limits>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <condition_variable>
 #include "soplex.h"
 #include <memory>
 #include <soplex/dsvector.h>
 #include <soplex/lprow.h>
 #include <boost/bimap.hpp>
 #include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+#include "stats.hpp"
+#include "gmpalloc.hpp"
 
 // Timing
 #include <sys/time.h>
 
+// Memory report
+#include <sys/resource.h>
+#include <unistd.h>
+
 // Parallelization
 #include <tbb/tbb.h>
 
@@ -71,12 +82,16 @@ class SVectorRat : public map<int, Rational>
 
 
 // Input and output files
-ifstream certificateFile;
+Tokenizer certificateFile;
 ofstream completedFile;
 
 // Settings
 bool debugmode = false;
 bool usesoplex = true;
+bool fpfirst = false; // complete incomplete derivations from a floating-point solve if possible
+bool usecache = true; // reuse completions of incomplete derivations with the same LP
+const char* statsFileName = nullptr; // JSON file for the statistics (--stats)
+double progressInterval = 60; // seconds between two progress lines (0 = none)
 
 // Global variables
 DSVectorRational dummycol(0); // SoPlex placeholder column
@@ -85,10 +100,21 @@ DSVectorPointer ObjCoeff(make_shared<DSVectorRational>()); // sparse vector of o
 size_t numberOfVariables;
 
 unsigned int nthreads = thread::hardware_concurrency();
+int maxpoollps = -1; // maximal number of LP copies for completions, 2 * nthreads if negative
 
-struct Constraint {DSVectorPointer vec; Rational side; int sense; string line;}; // @todo: take care of deep copies here!
+struct Constraint {DSVectorPointer vec; Rational side; int sense;}; // @todo: take care of deep copies here!
 vector<Constraint> constraints;
 
+// completions of incomplete derivations by objective row, sense, side and active derivations
+tbb::concurrent_unordered_map<string, string> completionCache;
+atomic<size_t> cacheHits(0);
+atomic<size_t> cacheMisses(0);
+
+// phase times and counters, written to statsFileName
+Stats stats;
+size_t numberOfIncomplete = 0; // incomplete derivations read
+size_t numberOfWeak = 0; // weak derivations read
+
 typedef boost::bimap<int, long> bimap; // maps rows of the LP to corresponding indices in the certificate used for updating the local LPs
 map<int, long> origConsCertIndex;
 
@@ -96,8 +122,26 @@ vector<tuple<Rational,Rational,long>> lowerBounds; // rational boundval, multipl
 vector<tuple<Rational,Rational,long>> upperBounds; // rational boundval, multiplier, long certindex
 
 
-struct passData { SoPlex passLp; bimap LProwCertificateMap;};
-struct parallelData { passData* bufData; stringstream linestream; bool needscompletion; std::vector<size_t> conidx; string line;};
+// LP used by one completion at a time; the rows of derivations stay in the LP for the next completion,
+// together with the basis of the last solve
+struct passData
+{
+   SoPlex passLp;
+   bimap LProwCertificateMap;
+   vector<long> activeDerivations; // sorted, derivations that are rows of passLp
+   vector<SPxSolver::VarStatus> colBasis;
+   vector<SPxSolver::VarStatus> rowBasis; // statuses of the rows of the CON section
+   map<long, SPxSolver::VarStatus> derivationBasis; // statuses of derivation rows by certificate index
+   bool hasSavedBasis = false;
+   size_t addedRows = 0;
+   size_t removedRows = 0;
+   size_t completions = 0;
+   size_t fpCompletions = 0; // completions from the floating-point solve
+   size_t creationMemory = 0; // growth of resident memory when the copy was created
+   size_t solves = 0; // calls of SoPlex, exact and floating-point
+   size_t iterations = 0; // simplex iterations of all solves
+};
+struct parallelData { passData* bufData = nullptr; std::vector<string> lines; size_t firstidx; bool needscompletion; bool needslp; std::vector<long> activeDerivations;};
 
 // circular buffer (also known as ring buffer, circular queue, cyclic queue), references:
 // https://oneapi-src.github.io/oneTBB/main/tbb_userguide/Using_Circular_Buffers.html
@@ -106,6 +150,8 @@ class circBuf
 {
    int tail, head, size;
    std::vector<passData*> arr;
+   std::mutex mtx;
+   std::condition_variable returned;
    public:
    circBuf( int maxtokens )
    {
@@ -122,30 +168,57 @@ class circBuf
    }
    void enqueue(passData* warmStartData);
    passData* dequeue();
-   bool isEmpty() { return head == -1; }
+   passData* dequeue(const std::vector<long>& activeDerivations);
+   bool isEmpty() { std::lock_guard<std::mutex> lock(mtx); return head == -1; }
 };
 
-void circBuf::enqueue( passData* warmStartData )
+// number of derivations that are in exactly one of the sorted vectors
+static size_t symmetricDifference( const std::vector<long>& a, const std::vector<long>& b )
 {
-   if( head == -1 )
-   {
-      head = tail = 0;
-      arr[tail] = warmStartData;
-   }
-   else if( (tail == size-1) && (head != 0) )
+   size_t i = 0, j = 0, diff = 0;
+
+   while( i < a.size() && j < b.size() )
    {
-      tail = 0;
-      arr[tail] = warmStartData;
+      if( a[i] < b[j] )
+         diff++, i++;
+      else if( b[j] < a[i] )
+         diff++, j++;
+      else
+         i++, j++;
    }
-   else
+
+   return diff + (a.size() - i) + (b.size() - j);
+}
+
+void circBuf::enqueue( passData* warmStartData )
+{
    {
-      tail++;
-      arr[tail] = warmStartData;
+      std::lock_guard<std::mutex> lock(mtx);
+
+      if( head == -1 )
+      {
+         head = tail = 0;
+         arr[tail] = warmStartData;
+      }
+      else if( (tail == size-1) && (head != 0) )
+      {
+         tail = 0;
+         arr[tail] = warmStartData;
+      }
+      else
+      {
+         tail++;
+         arr[tail] = warmStartData;
+      }
    }
+
+   returned.notify_one();
 }
 
 passData* circBuf::dequeue()
 {
+   std::lock_guard<std::mutex> lock(mtx);
+
    passData* data = arr[head];
    if( head == tail )
    {
@@ -163,9 +236,42 @@ passData* circBuf::dequeue()
    return data;
 }
 
+// dequeue the LP whose rows differ least from the given active derivations, so that few rows have to
+// be added and removed before solving; waits until an LP is returned if all are in use
+passData* circBuf::dequeue( const std::vector<long>& activeDerivations )
+{
+   {
+      std::unique_lock<std::mutex> lock(mtx);
+      returned.wait(lock, [this] { return head != -1; });
+
+      int best = head;
+      size_t bestdiff = std::numeric_limits<size_t>::max();
+
+      for( int i = head; ; i = (i == size-1) ? 0 : i+1 )
+      {
+         size_t diff = symmetricDifference(arr[i]->activeDerivations, activeDerivations);
+         if( diff < bestdiff )
+         {
+            best = i;
+            bestdiff = diff;
+         }
+         if( i == tail || bestdiff == 0 )
+            break;
+      }
+
+      std::swap(arr[head], arr[best]);
+   }
+
+   return dequeue();
+}
+
 
 
 // Forward declaration
+// The section readers and readMultipliers/readLinComb are not those of vipr::Certificate: the readers
+// copy every entry to the completed file while reading it and build the SoPlex LP, the rows are kept as
+// SoPlex DSVectorRational and Rational and the multipliers as SVectorRat for the completions, and
+// readMultipliers/readLinComb parse one buffered line of a batch instead of the tokenizer
 void modifyFileName( string &path, const string &newExtension );
 bool checkversion( string ver );
 bool processVER();
@@ -175,17 +281,17 @@ bool processOBJ( SoPlex &workinglp );
 bool processCON( SoPlex &workinglp );
 bool processRTP();
 bool processSOL();
-bool processDER( SoPlex workinglp );
+bool processDER( SoPlex &workinglp );
 bool getConstraints( SoPlex &workinglp, string &consense, Rational &rhs, int &activeConstraint, size_t currentDerivation);
-std::string completelin( SoPlex &workinglp, bimap& LProwCertificateMap, Constraint &constraint);
+std::string completelin( passData *lpData, Constraint &constraint, const string& line);
 
 static bool completeWeakDomination(DSVectorRational &row, int consense, Rational &rhs, stringstream& completedLine,
-                                    stringstream &initialLine);
+                                    stringstream &initialLine, bool reportFailure = true);
 static bool readLinComb( int &sense, Rational &rhs, SVectorRat& coefficients, SVectorRat& mult,
                   int currentConstraintIndex, SVectorBool &assumptionList, stringstream &baseLine);
 static bool readMultipliers( int &sense, SVectorRat &mult, stringstream &initialLine );
-bool completeIncomplete( SoPlex &workinglp, bimap& LProwCertificateMap, vector<long> &activeDerivations, string label, stringstream& completedLine,
-                        stringstream &baseLine );
+bool completeIncomplete( passData &lpData, Constraint &constraint, vector<long> &activeDerivations, string label,
+                        stringstream& completedLine, stringstream &baseLine );
 bool printReasoningToLine(DVectorRational &dualmultipliers, DVectorRational &reducedcosts, stringstream& completedLine, bimap& LProwCertificateMap);
 
 // Global bound changes for completing weak
@@ -233,6 +339,14 @@ static void printUsage(const char* const argv[], int idx)
       "  --debugmode=on/off    enable extra debug output from viprcomp\n"
       "  --verbosity=<level>   set verbosity level inside SoPlex\n"
       "  --threads=<number>    maximal number of threads to use \n"
+      "  --cache=on/off        reuse the completion of incomplete derivations with the same objective, side and\
+      \n                        active derivations (default on)\n"
+      "  --lps=<number>        maximal number of LP copies for incomplete derivations, created when first needed\
+      \n                        (default twice the number of threads)\n"
+      "  --fpfirst=on/off      complete incomplete derivations from a floating-point solve and fall back to\
+      \n                        the exact solve only if the rounded multipliers do not dominate the derivation\n"
+      "  --stats=<file>        write phase times, counters and peak memory as JSON to file\n"
+      "  --progress=<seconds>  print the progress of the DER section every given seconds (default 60, 0 = never)\n"
       "\n";
    if(idx <= 0)
       cerr << "missing input file\n\n";
@@ -253,6 +367,8 @@ int main(int argc, char *argv[])
    int verbosity = 0;
    string path = "";
 
+   useScalableAllocatorForGMP();
+
    if( argc == 0 )
    {
       printUsage(argv, -1);
@@ -345,6 +461,27 @@ int main(int argc, char *argv[])
                cout << "Continue with default setings (SoPlex on)" << endl;
             }
          }
+         // try floating-point solves before exact ones
+         else if(strncmp(option, "fpfirst=", 8) == 0)
+         {
+            char* str = &option[8];
+            if( string(str) == "on")
+            {
+               fpfirst = true;
+               cout << "Floating-point first completion turned on." << endl;
+            }
+            else if( string(str) == "off")
+            {
+               fpfirst = false;
+               cout << "Floating-point first completion turned off." << endl;
+            }
+            else
+            {
+               cout << "Unknown input for floating-point first completion (on/off expected). Read "
+               << string(str) << " instead" << endl;
+               cout << "Continue with default setings (off)" << endl;
+            }
+         }
          // set maximal number of threads that should be used
          else if(strncmp(option, "threads=", 8) == 0)
          {
@@ -362,10 +499,54 @@ int main(int argc, char *argv[])
                   nthreads = maxthreads;
             }
          }
+         // reuse completions of identical LPs
+         else if(strncmp(option, "cache=", 6) == 0)
+         {
+            char* str = &option[6];
+            if( string(str) == "on")
+               usecache = true;
+            else if( string(str) == "off")
+               usecache = false;
+            else
+            {
+               cout << "Unknown input for completion cache (on/off expected). Read "
+               << string(str) << " instead" << endl;
+               cout << "Continue with default setings (cache on)" << endl;
+            }
+         }
+         // set maximal number of LP copies
+         else if(strncmp(option, "lps=", 4) == 0)
+         {
+            char* str = &option[4];
+            if( isdigit(option[4]) && atoi(str) > 0 )
+               maxpoollps = atoi(str);
+            else
+            {
+               cerr << "number of LPs has to be positive, read " << str << endl;
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
          else if(strncmp(option, "outfile=", 8) == 0)
          {
             path = string(&option[8]);
          }
+         // write statistics as JSON
+         else if(strncmp(option, "stats=", 6) == 0 && option[6] != '\0')
+         {
+            statsFileName = &option[6];
+         }
+         else if(strncmp(option, "progress=", 9) == 0)
+         {
+            char* str = &option[9];
+            if( isdigit(option[9]) )
+               progressInterval = atof(str);
+            else
+            {
+               printUsage(argv, optidx);
+               return 1;
+            }
+         }
          else
          {
             printUsage(argv, optidx);
@@ -408,6 +589,7 @@ int main(int argc, char *argv[])
    baselp.setRealParam(SoPlex::OPTTOL, 0.0);
 
    baselp.setIntParam(SoPlex::VERBOSITY, verbosity); // verbosity var prob. obsolete for parallelization
+   stats.setProgressInterval(progressInterval);
 
    struct timeval start, end;
    gettimeofday( &start, 0);
@@ -434,6 +616,22 @@ int main(int argc, char *argv[])
                                    << " seconds (Wall Clock)" << endl;
                         }
                      }
+
+   if( statsFileName != nullptr )
+   {
+      stats.endPhase();
+      stats.setInfo("tool", "viprcomp");
+      stats.setInfo("certificate", certificateFileName);
+      stats.setInfo("result", returnStatement == 0 ? "completed" : "failed");
+      stats.set("threads", nthreads);
+      stats.set("variables", numberOfVariables);
+      stats.set("derivations_incomplete", numberOfIncomplete);
+      stats.set("derivations_weak", numberOfWeak);
+      stats.set("cache_hits", cacheHits);
+      stats.set("cache_misses", cacheMisses);
+      stats.writeJSON(statsFileName, cerr);
+   }
+
    return returnStatement;
 }
 
@@ -474,6 +672,8 @@ bool checkVersion(string version)
 // Error if the version is incompatible or not specified
 bool processVER()
 {
+   stats.startPhase("VER");
+
    bool returnStatement = false;
    string tmpStr;
 
@@ -509,6 +709,7 @@ break;
 bool processVAR(SoPlex &workinglp)
 {
    cout << endl << "Processing VAR section..." << endl;
+   stats.startPhase("VAR");
 
    auto returnStatement = true;
 
@@ -574,6 +775,7 @@ bool processINT()
    size_t numberOfIntegers;
 
    cout << endl << "Processing INT section..." << endl;
+   stats.startPhase("INT");
 
    bool returnStatement = false;
 
@@ -628,6 +830,7 @@ bool processOBJ(SoPlex &workinglp)
    VectorRational Objective(0); // full objective Vector
 
    cout << endl << "Processing OBJ section..." << endl;
+   stats.startPhase("OBJ");
 
    certificateFile >> section;
 
@@ -691,6 +894,7 @@ bool processCON(SoPlex &workinglp)
    size_t numberOfConstraints, numberOfBoundedCons, currentDerivation;
 
    cout << endl << "Processing CON section..." << endl;
+   stats.startPhase("CON");
 
    certificateFile >> section;
    if( section!= "CON" )
@@ -720,6 +924,7 @@ bool processCON(SoPlex &workinglp)
 bool processRTP()
 {
    cout << endl << "Processing RTP section..." << endl;
+   stats.startPhase("RTP");
 
    bool returnStatement = false;
 
@@ -769,6 +974,7 @@ bool processSOL()
    size_t numberOfSolutions;
 
    cout << endl << "Processing SOL section... " << endl;
+   stats.startPhase("SOL");
 
    certificateFile >> section;
 
@@ -882,85 +1088,140 @@ static size_t pushLineToConstraints(string& line, size_t conidx)
          cerr << "wrong sense for constraints " << consense << endl;
          break;
    }
-   constraints[conidx] = {row, rhs, sense, line};
+   constraints[conidx] = {row, rhs, sense};
    return constraints.size() - 1;
 }
 
-// read data from certificateFile and buffer it correctly in the stringstream of returnData
-static void processSequentialInputFilter(parallelData& returnData, size_t& lineindex, tbb::flow_control& fc)
+// a derivation line is completed if it is marked weak or incomplete
+static bool needsCompletion(const string& line)
 {
-   string line;
-   bool stop = false;
-   int nbufferedlines = 0;
+   return (line.find("weak") != string::npos) || (line.find("incomplete") != string::npos);
+}
+
+// record that the derivation in line lineindex reads constraint conidx
+static void updateLastUse(vector<long>& lastUse, long conidx, size_t lineindex, size_t numberOfConstraints)
+{
+   if( conidx >= (long) numberOfConstraints && conidx - numberOfConstraints < lastUse.size() )
+      lastUse[conidx - numberOfConstraints] = max(lastUse[conidx - numberOfConstraints], (long) lineindex);
+}
+
+// collect the constraints read by completing the derivation in line lineindex: the multipliers of
+// weak derivations, the active constraints of incomplete derivations, and the derivation itself
+static void collectReferences(const string& line, size_t lineindex, size_t numberOfConstraints, vector<long>& lastUse)
+{
+   stringstream linestream(line);
+   string tmp;
+
+   updateLastUse(lastUse, lineindex, lineindex, numberOfConstraints);
+
+   while( linestream >> tmp && tmp != "{" );
 
-   stringstream passstream;
-   bool lineneedscompletion = false;
-   size_t filepos = certificateFile.tellg();
+   linestream >> tmp >> tmp;
 
-   while( !stop && getline(certificateFile, line) )
+   if( tmp == "incomplete" )
    {
-      lineneedscompletion = (line.find("weak") != string::npos) || (line.find("incomplete") != string::npos);
-      // line needs to be completed -> only one line at a time
-      if( lineneedscompletion )
-      {
-         if( nbufferedlines == 0 )
-         {
-            returnData.conidx.push_back(lineindex);
-            pushLineToConstraints(line, lineindex);
-            lineindex++;
-            nbufferedlines++;
-            passstream << line;
-            stop = true;
-         }
-         else
-         {
-            // reset to beginning of line
-            certificateFile.seekg(filepos);
-            stop = true;
-            lineneedscompletion = false;
-         }
-      }
-      else
-      {
-         returnData.conidx.push_back(lineindex);
-         pushLineToConstraints(line, lineindex);
-         lineindex++;
-         passstream << line << std::endl;
-         nbufferedlines++;
-         if( nbufferedlines >= 10 )
-            stop = true;
-      }
-      filepos = certificateFile.tellg();
+      while( linestream >> tmp && tmp != "}" )
+         updateLastUse(lastUse, atol(tmp.c_str()), lineindex, numberOfConstraints);
    }
+   else if( tmp == "weak" )
+   {
+      int nbounds = 0, k = 0;
+      long idx;
 
-   returnData.needscompletion = lineneedscompletion;
+      linestream >> tmp >> nbounds;
+      for( int i = 0; i < nbounds; ++i )
+         linestream >> tmp >> tmp >> tmp >> tmp;
 
-   if( nbufferedlines > 0 )
-      returnData.linestream << passstream.rdbuf();
-   else
-      fc.stop();
+      linestream >> tmp >> k;
+      for( int i = 0; i < k && linestream >> idx >> tmp; ++i )
+         updateLastUse(lastUse, idx, lineindex, numberOfConstraints);
+   }
+}
+
+// sorted active derivations of an incomplete derivation, returns false for all other lines
+static bool readActiveDerivations(const string& line, vector<long>& activeDerivations)
+{
+   auto pos = line.find("incomplete");
+   string tmp;
+
+   activeDerivations.clear();
+   if( pos == string::npos )
+      return false;
+
+   stringstream linestream(line.substr(pos + 10));
+   while( linestream >> tmp && tmp != "}" )
+      activeDerivations.push_back(atol(tmp.c_str()));
+
+   sort(activeDerivations.begin(), activeDerivations.end());
+   return true;
 }
 
-// read data from certificateFile and buffer it correctly in the stringstream of returnData
-static void readFileIntoMemory(size_t initialLine, std::vector<size_t>& toCompleteLines)
+// read the next batch of derivation lines; a batch ends after the first line that needs completion
+// only derivations that are read by a completion later on are parsed
+static void readDerivationBatch(parallelData& returnData, size_t& lineindex, size_t endindex,
+                                size_t numberOfConstraints, const vector<long>& lastUse)
 {
    string line;
-   size_t lineindex = initialLine;
-   bool lineneedscompletion = false;
 
-   while( getline(certificateFile, line) )
+   returnData.firstidx = lineindex;
+   returnData.needscompletion = false;
+   returnData.needslp = false;
+
+   while( lineindex < endindex && returnData.lines.size() < 64 && getline(certificateFile, line) )
    {
-      lineneedscompletion = (line.find("weak") != string::npos) || (line.find("incomplete") != string::npos);
-      // line needs to be completed -> only one line at a time
-      if( lineneedscompletion )
-         toCompleteLines.push_back(lineindex);
+      if( lastUse[lineindex - numberOfConstraints] >= 0 )
+         pushLineToConstraints(line, lineindex);
 
-      pushLineToConstraints(line, lineindex);
+      returnData.needscompletion = needsCompletion(line);
+      if( returnData.needscompletion )
+      {
+         if( line.find("incomplete") != string::npos )
+            numberOfIncomplete++;
+         else
+            numberOfWeak++;
+      }
+      returnData.lines.push_back(std::move(line));
       lineindex++;
+
+      if( returnData.needscompletion )
+      {
+         returnData.needslp = readActiveDerivations(returnData.lines.back(), returnData.activeDerivations);
+         break;
+      }
    }
 }
 
-bool processDER(SoPlex workinglp)
+// resident memory of the process in bytes, 0 if unknown
+static size_t residentMemory()
+{
+   size_t pages, resident;
+   ifstream statm("/proc/self/statm");
+
+   if( statm >> pages >> resident )
+      return resident * sysconf(_SC_PAGESIZE);
+
+   return 0;
+}
+
+// copy of the LP for completing incomplete derivations
+static passData* createPoolLP(SoPlex &workinglp)
+{
+   size_t memory = residentMemory();
+   passData* queueData = new passData[1];
+
+   queueData->passLp.setIntParam(SoPlex::READMODE, SoPlex::READMODE_RATIONAL);
+   queueData->passLp.setIntParam(SoPlex::SOLVEMODE, SoPlex::SOLVEMODE_RATIONAL);
+   queueData->passLp.setIntParam(SoPlex::CHECKMODE, SoPlex::CHECKMODE_RATIONAL);
+   queueData->passLp.setIntParam(SoPlex::SYNCMODE, SoPlex::SYNCMODE_AUTO);
+   queueData->passLp.setRealParam(SoPlex::FEASTOL, 0.0);
+   queueData->passLp.setRealParam(SoPlex::OPTTOL, 0.0);
+   queueData->passLp = workinglp;
+   queueData->creationMemory = residentMemory() - min(memory, residentMemory());
+
+   return queueData;
+}
+
+bool processDER(SoPlex &workinglp)
 {
    bool returnStatement = false;
    string section;
@@ -968,11 +1229,15 @@ bool processDER(SoPlex workinglp)
    size_t numberOfConstraints = constraints.size();
    size_t completedLines = 0;
    size_t lineindex;
+   size_t endindex;
    timeval start, end;
-   std::vector<size_t> toCompleteLines;
-   std::vector<string> completedlines;
+   vector<long> lastUse; // last derivation that reads a constraint, -1 if it is never read
+   vector<pair<long, size_t>> releaseOrder; // derivations ordered by their last use
+   size_t nextRelease = 0;
+   size_t numberOfParsed = 0;
 
    cout << endl << "Processing DER section... " << endl;
+   stats.startPhase("DER scan");
    certificateFile >> section;
 
    gettimeofday( &start, 0 );
@@ -1000,118 +1265,191 @@ bool processDER(SoPlex workinglp)
    certificateFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
    cout << "Available threads: " << nthreads << endl;
+#ifdef VIPR_WITH_TBBMALLOC
+   cout << "Memory allocator: tbbmalloc, also for GMP" << endl;
+#endif
 
    lineindex = numberOfConstraints;
+   endindex = numberOfConstraints + numberOfDerivations;
 
-   readFileIntoMemory(lineindex, toCompleteLines);
+   // first pass: find the derivations that completions read and when they are read for the last time;
+   // input that cannot be read twice keeps all derivations
+   if( certificateFile.canSeek() )
+   {
+      streampos derstart = certificateFile.tellg();
+      string line;
 
-   circBuf circQueue(0);
+      lastUse.resize(numberOfDerivations, -1);
 
-   // generate and queue the LPs that are needed in parallel
-   if( usesoplex )
-   {
-      circQueue.resize(2 * nthreads);
-      for(int i = 0; i < 2 * nthreads; ++i)
+      for( size_t i = lineindex; i < endindex && getline(certificateFile, line); ++i )
       {
-         passData* queueData = new passData[1];
-         //queueData->passLp();
-         queueData->passLp.setIntParam(SoPlex::READMODE, SoPlex::READMODE_RATIONAL);
-         queueData->passLp.setIntParam(SoPlex::SOLVEMODE, SoPlex::SOLVEMODE_RATIONAL);
-         queueData->passLp.setIntParam(SoPlex::CHECKMODE, SoPlex::CHECKMODE_RATIONAL);
-         queueData->passLp.setIntParam(SoPlex::SYNCMODE, SoPlex::SYNCMODE_AUTO);
-         queueData->passLp.setRealParam(SoPlex::FEASTOL, 0.0);
-         queueData->passLp.setRealParam(SoPlex::OPTTOL, 0.0);
-         queueData->passLp = workinglp;
-         circQueue.enqueue(queueData);
+         if( needsCompletion(line) )
+            collectReferences(line, i, numberOfConstraints, lastUse);
+      }
+
+      certificateFile.clear();
+      certificateFile.seekg(derstart);
+
+      if( certificateFile.fail() )
+      {
+         cerr << "Failed to return to the start of the DER section" << endl;
+         return false;
       }
-   }
 
-   // reset the line index
-   lineindex = 0;
+      for( size_t i = 0; i < numberOfDerivations; ++i )
+      {
+         if( lastUse[i] >= 0 )
+            releaseOrder.push_back(make_pair(lastUse[i], numberOfConstraints + i));
+      }
+      sort(releaseOrder.begin(), releaseOrder.end());
+      numberOfParsed = releaseOrder.size();
+   }
+   else
+   {
+      lastUse.resize(numberOfDerivations, numeric_limits<long>::max());
+      numberOfParsed = numberOfDerivations;
+   }
 
    gettimeofday( &end, 0 );
-   cout << endl << "processing file into memory took " << getTimeSecs(start, end)
-        << " seconds (Wall Clock)" << endl;
+   cout << endl << "scanning references took " << getTimeSecs(start, end)
+        << " seconds (Wall Clock), " << numberOfParsed << " derivations are read by completions" << endl;
 
+   stats.startPhase("DER");
    gettimeofday( &start, 0 );
 
+   // LP copies are only created when an incomplete derivation finds no free one; since at most as many
+   // batches as LP copies are in the pipeline, there is always a free copy or room for a new one, and
+   // otherwise the derivation waits for a copy to be returned
+   int poolsize = (maxpoollps > 0) ? maxpoollps : 2 * nthreads;
+   int createdlps = 0;
+   circBuf circQueue(poolsize);
 
-   // pipeline to complete the derivations
-   tbb::parallel_pipeline(nthreads,
-      // sequential filter to manage the circular buffer and to ensure output is in correct order
+   completedFile << endl;
+
+   // pipeline to read, complete and write the derivations; lines are written in order as soon as
+   // all lines before them are done
+   tbb::parallel_pipeline(min((int) nthreads, poolsize),
+      // sequential filter to read and parse the input and to hand out LPs from the circular buffer
       tbb::make_filter<void, parallelData>( tbb::filter_mode::serial_in_order,
          [&]( tbb::flow_control& fc) {
             parallelData returnData;
-            while(lineindex != toCompleteLines.size())
+            readDerivationBatch(returnData, lineindex, endindex, numberOfConstraints, lastUse);
+            if( returnData.lines.empty() )
             {
-               if( usesoplex )
-                  returnData.bufData = circQueue.dequeue();
-               returnData.conidx.push_back(toCompleteLines[lineindex]);
-               lineindex++;
+               fc.stop();
                return returnData;
             }
-            fc.stop();
+            if( usesoplex && returnData.needslp )
+            {
+               if( circQueue.isEmpty() && createdlps < poolsize )
+               {
+                  returnData.bufData = createPoolLP(workinglp);
+                  createdlps++;
+               }
+               else
+                  returnData.bufData = circQueue.dequeue(returnData.activeDerivations);
+            }
             return returnData;
          }
       ) &
-      // parallel processing and completion of derivations -> passes completed line to last filter
+      // parallel completion of derivations -> passes completed line to last filter
       tbb::make_filter<parallelData, parallelData>( tbb::filter_mode::parallel,
          [&]( parallelData returnData ) {
-            returnData.line = completelin(returnData.bufData->passLp, returnData.bufData->LProwCertificateMap, constraints[returnData.conidx[0]]);
+            if( returnData.needscompletion )
+            {
+               size_t conidx = returnData.firstidx + returnData.lines.size() - 1;
+               returnData.lines.back() = completelin(returnData.bufData, constraints[conidx], returnData.lines.back());
+            }
             return returnData;
          }
       ) &
-      //  manages the queueing of the circular buffer and pushes the completed lines to a vector in the correct order
+      // writes the lines in the correct order, returns the LP to the circular buffer and frees the
+      // derivations that are not read anymore
       tbb::make_filter<parallelData, void>( tbb::filter_mode::serial_in_order,
             [&]( parallelData returnData ) {
+            for( auto& line : returnData.lines )
+               completedFile << line << '\n';
 
-            completedlines.push_back(returnData.line);
-            if( usesoplex )
+            if( returnData.needscompletion )
+               completedLines++;
+
+            if( returnData.bufData != nullptr )
                circQueue.enqueue(returnData.bufData);
+
+            stats.progress(returnData.firstidx + returnData.lines.size() - numberOfConstraints,
+                           numberOfDerivations, "derivations", cout);
+
+            size_t lastidx = returnData.firstidx + returnData.lines.size() - 1;
+            while( nextRelease < releaseOrder.size() && (size_t) releaseOrder[nextRelease].first <= lastidx )
+            {
+               constraints[releaseOrder[nextRelease].second] = Constraint();
+               nextRelease++;
+            }
             }
          )
       );
 
    if( usesoplex )
    {
-      while(!circQueue.isEmpty())
+      size_t addedRows = 0, removedRows = 0, lpCompletions = 0, fpCompletions = 0, solves = 0, iterations = 0;
+      struct rusage usage;
+
+      cout << endl << "LP copies created: " << createdlps << " (at most " << poolsize << ")" << endl;
+
+      for( int i = 0; !circQueue.isEmpty(); ++i )
       {
          passData* data = circQueue.dequeue();
+         cout << "  LP " << i << ": " << data->passLp.numRows() << " rows, " << data->passLp.numNonzeros()
+              << " nonzeros, " << data->completions << " completions, "
+              << data->creationMemory / (1024.0 * 1024.0) << " MB resident when created" << endl;
+         addedRows += data->addedRows;
+         removedRows += data->removedRows;
+         lpCompletions += data->completions;
+         fpCompletions += data->fpCompletions;
+         solves += data->solves;
+         iterations += data->iterations;
          delete[] data;
       }
+
+      stats.set("lp_copies", createdlps);
+      stats.set("lp_completions", lpCompletions);
+      stats.set("lp_fp_completions", fpCompletions);
+      stats.set("lp_rows_added", addedRows);
+      stats.set("lp_rows_removed", removedRows);
+      stats.set("soplex_solves", solves);
+      stats.set("soplex_iterations", iterations);
+
+      cout << "LP completions: " << lpCompletions << ", derivation rows added: " << addedRows
+           << ", removed: " << removedRows << endl;
+      if( getrusage(RUSAGE_SELF, &usage) == 0 )
+         cout << "Peak resident memory: " << usage.ru_maxrss / 1024.0 << " MB" << endl;
+      if( fpfirst )
+         cout << "Completed from floating-point solves: " << fpCompletions << " out of " << lpCompletions << endl;
+      if( usecache )
+         cout << "Completion cache: " << cacheHits << " hits, " << cacheMisses << " misses" << endl;
    }
 
+   completedFile.flush();
 
    gettimeofday( &end, 0 );
    cout << endl << "processing completion pipeline took " << getTimeSecs(start, end)
-        << " seconds (Wall Clock)" << endl;
-
-   gettimeofday(&start, 0 );
+        << " seconds (Wall Clock)" << endl << endl;
 
-   // output the lines to the certificate
-   int c = 0;
-   completedFile << endl;
-   for( auto i = numberOfConstraints; i < constraints.size(); ++i )
+   if( lineindex != endindex )
    {
-      if( toCompleteLines.size() == 0 || c >= toCompleteLines.size() || i != toCompleteLines[c] )
-         completedFile << constraints[i].line << endl;
-      else
-      {
-         completedFile << completedlines[c] << endl;
-         c++;
-      }
+      cerr << "Expected " << numberOfDerivations << " derivations, but read only " << lineindex - numberOfConstraints << endl;
+      return false;
    }
 
-   gettimeofday( &end, 0 );
-   cout << endl << "writing to file took " << getTimeSecs(start, end)
-        << " seconds (Wall Clock)" << endl << endl;
-
-   std::cout << "Completed " << toCompleteLines.size() << " out of " << numberOfDerivations << endl;
+   std::cout << "Completed " << completedLines << " out of " << numberOfDerivations << endl;
+   stats.set("derivations", numberOfDerivations);
+   stats.set("derivations_completed", completedLines);
    return true;
 }
 
 
 
+
 // Read Coefficients for any constraint
 // Modify main LP
 bool getConstraints(SoPlex &workinglp, string &consense, Rational &rhs, int &activeConstraint, size_t currentDerivation)
@@ -1226,14 +1564,38 @@ bool getConstraints(SoPlex &workinglp, string &consense, Rational &rhs, int &act
          returnStatement = false;
    }
 
-   constraints.push_back({row, Rational(rhs), sense, ""});
+   constraints.push_back({row, Rational(rhs), sense});
 
    return returnStatement;
 }
 
-string completelin( SoPlex &workinglp,  bimap& LProwCertificateMap, Constraint& constraint)
+// key of an incomplete derivation in the completion cache from its sorted active derivations, appended to
+// one string instead of being formatted through a stringstream
+static string completionKey( const Constraint& constraint, const vector<long>& activeDerivations )
+{
+   string key = to_string(constraint.sense) + " " + constraint.side.str();
+
+   if( constraint.vec == ObjCoeff )
+      key += " OBJ";
+   else
+   {
+      key += " " + to_string(constraint.vec->size());
+      for( int i = 0; i < constraint.vec->size(); ++i )
+      {
+         key += " " + to_string(constraint.vec->index(i)) + " ";
+         key += constraint.vec->value(i).str();
+      }
+   }
+
+   key += " :";
+   for( auto i : activeDerivations )
+      key += " " + to_string(i);
+
+   return key;
+}
+
+string completelin( passData *lpData, Constraint& constraint, const string& line)
 {
-   string& line = constraint.line;
    int consense = constraint.sense;
    Rational& rhs = constraint.side;
    DSVectorPointer row = constraint.vec;
@@ -1252,12 +1614,37 @@ string completelin( SoPlex &workinglp,  bimap& LProwCertificateMap, Constraint&
    {
       string tmp;
 
-      assert(usesoplex);
-      if( !usesoplex )
+      assert(usesoplex && lpData != nullptr);
+      if( !usesoplex || lpData == nullptr )
       {
          cerr << "Soplex support must be enabled to process incomplete constraint type. Rerun with parameter soplex=ON." << endl;
          return "";
       }
+      linestream >> tmp;
+      while( tmp != "}" )
+      {
+         activeDerivations.push_back(stol(tmp));
+         linestream >> tmp;
+      }
+      linestream.seekg(0);
+      sort(activeDerivations.begin(), activeDerivations.end());
+
+      string key;
+      if( usecache )
+      {
+         key = completionKey(constraint, activeDerivations);
+
+         auto cached = completionCache.find(key);
+         if( cached != completionCache.end() )
+         {
+            cacheHits++;
+            completedDerivation << cached->second << " -1 ";
+            return line.substr(0,derivationstart + 3) + completedDerivation.str();
+         }
+         cacheMisses++;
+      }
+
+      SoPlex& workinglp = lpData->passLp;
       VectorRational newObjective(0);
       newObjective.reSize(workinglp.numColsRational());
       newObjective.reDim(workinglp.numColsRational());
@@ -1273,14 +1660,11 @@ string completelin( SoPlex &workinglp,  bimap& LProwCertificateMap, Constraint&
       else
          workinglp.setIntParam(SoPlex::OBJSENSE, SoPlex::OBJSENSE_MAXIMIZE);
 
-      linestream >> tmp;
-      while( tmp != "}" )
-      {
-         activeDerivations.push_back(stol(tmp));
-         linestream >> tmp;
-      }
-      linestream.seekg(0);
-      retval = completeIncomplete( workinglp, LProwCertificateMap, activeDerivations, "", completedDerivation, linestream );
+      retval = completeIncomplete( *lpData, constraint, activeDerivations, "", completedDerivation, linestream );
+
+      // failed completions are written as incomplete again and are not reused
+      if( usecache && retval )
+         completionCache.insert(make_pair(key, completedDerivation.str()));
 #ifndef NDEBUG
       cout << "Completed derivation: " << line.substr(0,10) << endl;
 #endif
@@ -1386,7 +1770,7 @@ static bool readLinComb( int &sense, Rational &rhs, SVectorRat& coefficients, SV
 
 // Complete "lin"-type derivations marked "weak"
 static bool completeWeakDomination(DSVectorRational &row, int consense, Rational &rhs, stringstream& completedLine,
-                                    stringstream &baseLine)
+                                    stringstream &baseLine, bool reportFailure)
 {
    SVectorRat coefDer;
    SVectorRat multDer;
@@ -1613,10 +1997,13 @@ static bool completeWeakDomination(DSVectorRational &row, int consense, Rational
             success = true;
          else
          {
-            cerr << "invalid claim of infeasibility " << endl;
+            if( reportFailure )
+               cerr << "invalid claim of infeasibility " << endl;
             success = false;
          }
       }
+      else if( !reportFailure )
+         success = false;
       else
       {
          cerr.precision(numeric_limits<double>::max_digits10);
@@ -1642,9 +2029,189 @@ static bool completeWeakDomination(DSVectorRational &row, int consense, Rational
    return success;
 }
 
-bool completeIncomplete( SoPlex &localLP,  bimap& LProwCertificateMap, vector<long> &newActiveDerivations, string label, stringstream& completedLine,
-                        stringstream &baseLine )
+// save the basis of the last solve; derivation rows are stored by certificate index so that the basis
+// can be restored after rows have been added and removed
+static void saveBasis( passData &lpData )
 {
+   SoPlex& localLP = lpData.passLp;
+   vector<SPxSolver::VarStatus> rows(localLP.numRows());
+
+   lpData.colBasis.resize(localLP.numCols());
+   lpData.rowBasis.clear();
+   lpData.derivationBasis.clear();
+   lpData.hasSavedBasis = localLP.getBasis(rows.data(), lpData.colBasis.data());
+
+   if( !lpData.hasSavedBasis )
+      return;
+
+   for( int i = 0; i < localLP.numRows(); ++i )
+   {
+      auto res = lpData.LProwCertificateMap.left.find(i);
+      if( res != lpData.LProwCertificateMap.left.end() )
+         lpData.derivationBasis[res->second] = rows[i];
+      else
+         lpData.rowBasis.push_back(rows[i]);
+   }
+}
+
+// restore the saved basis, rows that were added since are basic; the basis is only set if removing rows
+// kept it regular, i.e., if all removed rows were basic
+static void restoreBasis( passData &lpData )
+{
+   SoPlex& localLP = lpData.passLp;
+   vector<SPxSolver::VarStatus> rows(localLP.numRows());
+   size_t origRow = 0;
+   int numBasic = 0;
+
+   if( lpData.colBasis.size() != (size_t) localLP.numCols() )
+      return;
+
+   for( int i = 0; i < localLP.numRows(); ++i )
+   {
+      auto res = lpData.LProwCertificateMap.left.find(i);
+      rows[i] = SPxSolver::BASIC;
+
+      if( res != lpData.LProwCertificateMap.left.end() )
+      {
+         auto status = lpData.derivationBasis.find(res->second);
+         if( status != lpData.derivationBasis.end() )
+            rows[i] = status->second;
+      }
+      else if( origRow < lpData.rowBasis.size() )
+         rows[i] = lpData.rowBasis[origRow++];
+
+      if( rows[i] == SPxSolver::BASIC )
+         numBasic++;
+   }
+
+   for( auto status : lpData.colBasis )
+   {
+      if( status == SPxSolver::BASIC )
+         numBasic++;
+   }
+
+   if( numBasic == localLP.numRows() )
+      localLP.setBasis(rows.data(), lpData.colBasis.data());
+}
+
+// closest rational with denominator at most 2^20, by continued fractions; the exact duals of most
+// completion LPs have small denominators, which this recovers from their floating-point values
+static Rational roundToRational( double value )
+{
+   const double maxDenominator = 1 << 20;
+   double x = fabs(value);
+   double p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+
+   if( x < 1e-12 )
+      return Rational(0);
+
+   if( x > (1 << 30) )
+      return Rational(value);
+
+   while( true )
+   {
+      double a = floor(x);
+
+      if( a * q1 + q0 > maxDenominator )
+         break;
+
+      double p2 = a * p1 + p0;
+      double q2 = a * q1 + q0;
+
+      p0 = p1;
+      q0 = q1;
+      p1 = p2;
+      q1 = q2;
+
+      if( fabs(fabs(value) - p1 / q1) <= 1e-12 * max(1.0, fabs(value)) || x - a < 1e-12 )
+         break;
+
+      x = 1 / (x - a);
+   }
+
+   Rational result(p1);
+   result /= Rational(q1);
+
+   return value < 0 ? Rational(-result) : result;
+}
+
+// solve the LP in floating-point, round the duals to rationals and complete the derivation from them
+// like a weak derivation, i.e., mismatched coefficients are corrected with the global bounds; the
+// completion is only written if the result dominates the derivation exactly
+static bool completeFromFloatingPoint( passData &lpData, Constraint &constraint, stringstream& completedLine )
+{
+   SoPlex& localLP = lpData.passLp;
+   DVectorReal duals(localLP.numRows());
+   stringstream multipliers;
+   stringstream weakLine;
+   stringstream fpLine;
+   int numMultipliers = 0;
+   bool success = false;
+
+   // equality derivations cannot be completed as weak derivations
+   if( constraint.sense == 0 )
+      return false;
+
+   localLP.setIntParam(SoPlex::SOLVEMODE, SoPlex::SOLVEMODE_REAL);
+   localLP.setIntParam(SoPlex::CHECKMODE, SoPlex::CHECKMODE_REAL);
+   localLP.setRealParam(SoPlex::FEASTOL, 1e-9);
+   localLP.setRealParam(SoPlex::OPTTOL, 1e-9);
+
+   SPxSolver::Status stat = localLP.optimize();
+
+   lpData.solves++;
+   lpData.iterations += localLP.numIterations();
+
+   // the next completion starts from this basis also if no exact solve follows
+   if( stat == SPxSolver::OPTIMAL || stat == SPxSolver::INFEASIBLE )
+      saveBasis(lpData);
+
+   if( stat == SPxSolver::OPTIMAL && localLP.getDualReal(duals) )
+   {
+      for( int i = 0; i < duals.dim(); ++i )
+      {
+         long certIndex;
+         auto res = lpData.LProwCertificateMap.left.find(i);
+
+         if( res != lpData.LProwCertificateMap.left.end() )
+            certIndex = res->second;
+         else
+            certIndex = origConsCertIndex[i];
+
+         Rational mult = roundToRational(duals[i]);
+         int sign = constraints[certIndex].sense * mult.sign();
+
+         // drop multipliers that would be rejected for their sign
+         if( mult == 0 || (sign != 0 && sign != constraint.sense) )
+            continue;
+
+         multipliers << " " << certIndex << " " << mult;
+         numMultipliers++;
+      }
+
+      weakLine << "{ 0 } " << numMultipliers << multipliers.str();
+      success = completeWeakDomination(*constraint.vec, constraint.sense, constraint.side, fpLine, weakLine, false);
+   }
+
+   localLP.setIntParam(SoPlex::SOLVEMODE, SoPlex::SOLVEMODE_RATIONAL);
+   localLP.setIntParam(SoPlex::CHECKMODE, SoPlex::CHECKMODE_RATIONAL);
+   localLP.setRealParam(SoPlex::FEASTOL, 0.0);
+   localLP.setRealParam(SoPlex::OPTTOL, 0.0);
+
+   if( success )
+   {
+      completedLine << fpLine.str();
+      lpData.fpCompletions++;
+   }
+
+   return success;
+}
+
+bool completeIncomplete( passData &lpData, Constraint &constraint, vector<long> &newActiveDerivations, string label,
+                        stringstream& completedLine, stringstream &baseLine )
+{
+   SoPlex& localLP = lpData.passLp;
+   bimap& LProwCertificateMap = lpData.LProwCertificateMap;
    string tmp;
    long numrows, derHierarchy;
    int normalizedSense;
@@ -1743,12 +2310,29 @@ bool completeIncomplete( SoPlex &localLP,  bimap& LProwCertificateMap, vector<lo
       assert(ncurrent + 1 == localLP.numRowsRational());
    }
 
+   lpData.activeDerivations = newActiveDerivations;
+   lpData.addedRows += toAddDerivations.size();
+   lpData.removedRows += toDeleteDerivations.size();
+   lpData.completions++;
+
+   // warm start from the last basis of this LP if SoPlex discarded it, e.g., after a failed solve
+   if( !localLP.hasBasis() && lpData.hasSavedBasis )
+      restoreBasis(lpData);
+
+   if( fpfirst && completeFromFloatingPoint(lpData, constraint, completedLine) )
+      return true;
+
    SPxSolver::Status stat;
    numrows = localLP.numRows();
    dualmultipliers.reDim(numrows);
    reducedcosts.reDim(numberOfVariables);
 
    stat = localLP.optimize();
+   lpData.solves++;
+   lpData.iterations += localLP.numIterations();
+
+   if( stat == SPxSolver::OPTIMAL || stat == SPxSolver::INFEASIBLE )
+      saveBasis(lpData);
 
    if( stat == SPxSolver::OPTIMAL )
    {
@@ -1774,7 +2358,9 @@ bool completeIncomplete( SoPlex &localLP,  bimap& LProwCertificateMap, vector<lo
       completedLine << " incomplete";
       for( auto i: newActiveDerivations )
          completedLine << " " << i;
+      completedLine << " }";
 
+      return false;
    }
    return true;
 }
@@ -0,0 +1,655 @@
+/*
+*
+*   Copyright (c) 2016 Kevin K. H. Cheung
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <map>
+#include <vector>
+#include <cassert>
+#include <climits>
+#include <gmpxx.h>
+#include <gmp.h>
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+#include <memory>
+#include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+#include "certificate.hpp"
+#include "vipr.hpp"
+
+
+// Avoid using namespace std to avoid non-obvious complications (ambiguities)
+using std::map;
+using std::string;
+using std::shared_ptr;
+using std::vector;
+using std::ifstream;
+using std::make_shared;
+using std::endl;
+using std::pair;
+
+namespace vipr
+{
+
+// State of the check of one certificate; every check has its own, so that checks can run at once
+class CertificateCheck : public Certificate
+{
+   public:
+      CertificateCheck(std::ostream &out, std::ostream &err, Stats &stats, double progressInterval)
+         : Certificate(out, err, stats) { stats.setProgressInterval(progressInterval); }
+
+      // checks all sections of the opened certificate
+      bool check();
+
+   private:
+      DenseAccumulator accumulator; // reused buffer for checkLinComb
+      ArithmeticCounts arithmeticCounts; // statistics of exact arithmetic
+
+      bool processSOL();
+      bool processDER();
+      void printArithmeticCounts();
+      void collectStats(bool verified);
+};
+
+
+Checker::Checker(std::ostream &out, std::ostream &err) : _out(out), _err(err) {}
+
+
+void Checker::setProgressInterval(double seconds)
+{
+   _progressInterval = seconds;
+}
+
+
+bool Checker::checkFile(const char* filename)
+{
+   _stats = Stats();
+   CertificateCheck check(_out, _err, _stats, _progressInterval);
+
+   check.certificateFile.open(filename);
+
+   if( check.certificateFile.fail() )
+   {
+      _err << "Failed to open file " << filename << endl;
+      return false;
+   }
+
+   return check.check();
+}
+
+
+bool Checker::checkBuffer(const char* data, size_t size)
+{
+   _stats = Stats();
+   CertificateCheck check(_out, _err, _stats, _progressInterval);
+
+   check.certificateFile.openBuffer(data, size);
+
+   if( check.certificateFile.fail() )
+   {
+      _err << "Failed to read the certificate from memory" << endl;
+      return false;
+   }
+
+   return check.check();
+}
+
+
+bool Checker::checkStream(const ReadCallback &read)
+{
+   _stats = Stats();
+   CertificateCheck check(_out, _err, _stats, _progressInterval);
+
+   check.certificateFile.openStream(read);
+
+   if( check.certificateFile.fail() )
+   {
+      _err << "Failed to read the certificate from the stream" << endl;
+      return false;
+   }
+
+   return check.check();
+}
+
+
+// Checks the sections in order of appearance, each one needs the previous ones
+bool CertificateCheck::check()
+{
+   bool returnStatement = false;
+
+   if( processVER() )
+      if( processVAR() )
+         if( processINT() )
+            if( processOBJ() )
+               if( processCON() )
+                  if( processRTP() )
+                     if( processSOL() )
+                        if( processDER() ) {
+                           returnStatement = true;
+                           printArithmeticCounts();
+                        }
+
+   collectStats(returnStatement);
+
+   return returnStatement;
+}
+
+
+// Processes solutions to be verified
+// Checks constraints and bounds
+// Error if wrong format, type or if bounds violated by solution
+bool CertificateCheck::processSOL()
+{
+   out << endl << "Processing SOL section..." << endl;
+   stats.startPhase("SOL");
+
+   bool returnStatement = false;
+   mpq_class value;
+
+   string section, label;
+
+   certificateFile >> section;
+
+   // Check format
+   if( section != "SOL" )
+   {
+      err << "SOL expected.   Read instead " << section << endl;
+      return returnStatement;
+   }
+
+   certificateFile >> numberOfSolutions;
+
+   if( certificateFile.fail() )
+   {
+      err << "Failed to read number after SOL" << endl;
+   }
+   else if( numberOfSolutions < 0 )
+   {
+      err << "Invalid number after SOL: " << numberOfSolutions << endl;
+   }
+   else
+   {
+      auto satisfies = [this] (Constraint &con, const vector<mpq_class> &x)
+      {
+         bool returnStat = false;
+
+         mpq_class prod = denseActivity(*con.coefSVec(), x, arithmeticCounts);
+
+         if( con.getSense() < 0 )
+         {
+            returnStat = (prod <= con.getRhs());
+         }
+         else if( con.getSense() > 0 )
+         {
+            returnStat = (prod >= con.getRhs());
+         }
+         else
+         {
+            returnStat = (con.getRhs() == prod);
+         }
+
+         return returnStat;
+      };
+
+      shared_ptr<SVectorGMP> solutionSpecified(make_shared<SVectorGMP>());
+      vector<mpq_class> sol(numberOfVariables);
+
+      for( int i = 0; i < numberOfSolutions; ++i )
+      {
+         certificateFile >> label;
+         out << "checking solution " << label << endl;
+
+         if( !readConstraintCoefficients(solutionSpecified) )
+         {
+            err << "Failed to read solution." << endl;
+            goto TERMINATE;
+         }
+         else
+         {
+            for( int j = 0; j < numberOfVariables; ++j )
+            {
+              sol[j] = 0;
+            }
+
+            // Check integrality constraints
+            for( auto it = solutionSpecified->begin(); it != solutionSpecified->end(); ++it )
+            {
+               if( isInt[it->first] && !isInteger(it->second) )
+               {
+                  err << "Noninteger value for integer variable "
+                       << it->first << endl;
+                  goto TERMINATE;
+               }
+              sol[it->first] = it->second;
+            }
+
+            for( int j = 0; j < numberOfConstraints; ++j )
+            {
+               if( !satisfies(constraint[j], sol) )
+               {
+                  err << "Constraint " << j << " not satisfied." << endl;
+                  goto TERMINATE;
+               }
+            }
+         }
+
+         value = denseActivity(*objectiveCoefficients, sol, arithmeticCounts);
+
+         out << "   objval = " << value << endl;
+
+         // Update best value for the objective function
+         if( i )
+         {
+            if( isMin && value < bestObjectiveValue )
+            {
+               bestObjectiveValue = value;
+            }
+            else if( !isMin && value > bestObjectiveValue )
+            {
+               bestObjectiveValue = value;
+            }
+         }
+         else
+         {
+            bestObjectiveValue = value;
+         }
+      }
+
+      if( numberOfSolutions )
+      {
+         out << "Best objval: " << bestObjectiveValue << endl;
+
+         // Check if bounds are already violated
+         if( isMin && checkUpper && bestObjectiveValue > upperBound )
+         {
+            err << "Upper bound violated." << endl;
+            goto TERMINATE;
+         }
+         else if( !isMin && checkLower && bestObjectiveValue < lowerBound )
+         {
+            err << "Lower bound violated." << endl;
+            goto TERMINATE;
+         }
+      }
+
+      returnStatement = true;
+   }
+
+TERMINATE:
+   return returnStatement;
+}
+
+// Processes derived constraints
+// Checks derivation types and derived constraints
+// Finally confirms or rejects Solution and/or relation to prove
+// Error if wrong format, derived constraints differ from given
+bool CertificateCheck::processDER()
+{
+
+   out << endl << "Processing DER section..." << endl;
+   stats.startPhase("DER");
+
+   bool returnStatement = false;
+
+   string section;
+
+   certificateFile >> section;
+
+   if( section != "DER" )
+   {
+      err << "DER expected.   Read instead " << section << endl;
+      return false;
+   }
+
+   certificateFile >> numberOfDerivations;
+
+   out << "numberOfDerivations = " << numberOfDerivations << endl;
+
+
+   // No lower bound to check and no deriviations -> nothing to do
+   if( numberOfDerivations == 0 && !checkLower )
+   {
+      out << "Successfully checked solution for feasibility" << endl;
+      return true;
+   }
+
+   // no upper bound to check and no deriviations -> nothing to do
+   if( numberOfDerivations == 0 && !checkUpper )
+   {
+      out << "Successfully checked solution for feasibility" << endl;
+      return true;
+   }
+
+   string label;
+   int sense;
+   mpq_class rhs;
+
+   for( int i = 0; i < numberOfDerivations; ++i )
+   {
+      shared_ptr<SVectorGMP> coef(make_shared<SVectorGMP>());
+
+      if( !readConstraint(label, sense, rhs, coef) )
+      {
+         return false;
+      }
+
+      // Obtain derivation method and info
+      string bracket, kind;
+      int refIdx;
+
+      certificateFile >> bracket >> kind;
+
+      if( bracket != "{" )
+      {
+         err << "Expecting { but read instead " << bracket << endl;
+         return false;
+      }
+
+      DerivationType derivationType = DerivationType::UNKNOWN;
+
+      if( kind == "asm" )
+         derivationType = DerivationType::ASM;
+      else if( kind == "sol" )
+         derivationType = DerivationType::SOL;
+      else if( kind == "lin" )
+         derivationType = DerivationType::LIN;
+      else if( kind == "rnd" )
+         derivationType = DerivationType::RND;
+      else if( kind == "uns" )
+         derivationType = DerivationType::UNS;
+
+      // The constraint to be derived
+      Constraint toDer(label, sense, rhs, coef, (derivationType == DerivationType::ASM), emptyList);
+
+#ifdef MORE_DEBUG_OUTPUT
+      out << numberOfConstraints + i << " - deriving..." << label << endl;
+#endif
+
+      AssumptionSet assumptionList;
+
+      int newConIdx = constraint.size();
+
+      switch( derivationType )
+      {
+
+         // Assumption, i.e. set of assumptions only contains index of constraint
+         case DerivationType::ASM:
+            assumptionList = AssumptionSet(newConIdx);
+            certificateFile >> bracket;
+
+            if( bracket != "}" )
+            {
+               err << "Expecting } but read instead " << bracket << endl;
+               return false;
+            }
+            break;
+         // Linear combination or rounding
+         case DerivationType::LIN:
+         case DerivationType::RND:
+            {
+               SVectorGMP mult;
+               int senseDer;
+
+#ifndef NDEBUG
+               out << "reading linear combination" << std::endl;
+#endif
+
+               if( !readMultipliers(senseDer, mult) )
+                  return false;
+
+               // viprchk_parallel discards constraints after their index of last reference
+               for( auto it = mult.begin(); it != mult.end(); ++it )
+               {
+                  if( isReleased(it->first, newConIdx) )
+                  {
+                     err << "Accessing trashed constraint: " << constraint[it->first].label() << endl;
+                     return false;
+                  }
+               }
+
+               certificateFile >> bracket;
+
+               if( bracket != "}" )
+               {
+                  err << "Expecting } but read instead " << bracket << endl;
+                  return false;
+               }
+
+               if( !checkLinComb(toDer, derivationType, senseDer, mult, accumulator, arithmeticCounts) )
+                  return false;
+
+               // the derived constraint depends on the assumptions of the combined ones, which
+               // are trashed after their last reference
+               for( auto it = mult.begin(); it != mult.end(); ++it )
+               {
+                  Constraint &con = constraint[it->first];
+
+                  assumptionList.merge(con.getassumptionList());
+
+                  if( (con.getMaxRefIdx() <= newConIdx) && (con.getMaxRefIdx() >= 0) )
+                     con.trash();
+               }
+            }
+            break;
+
+            // Unsplit
+         case DerivationType::UNS:
+            {
+               int con1, asm1, con2, asm2;
+
+               certificateFile >> con1 >> asm1 >> con2 >> asm2;
+
+               if( certificateFile.fail() )
+               {
+                  err << "Error reading con1 asm1 con2 asm2" << endl;
+                  return false;
+               }
+
+               if( !canUnsplit(toDer, newConIdx, con1, asm1, con2, asm2) )
+               {
+                  err << label << ": unsplit failed" << endl;
+                  return false;
+               }
+
+               for( int index : { con1, con2, asm1, asm2 } )
+               {
+                  if( isReleased(index, newConIdx) )
+                  {
+                     err << "unsplitting trashed constraint: " << constraint[index].label() << endl;
+                     return false;
+                  }
+               }
+
+               // the assumptions of the branches are discharged
+               assumptionList = constraint[con1].getassumptionList().without(asm1);
+               assumptionList.merge(constraint[con2].getassumptionList().without(asm2));
+
+               certificateFile >> bracket;
+               if( bracket != "}" )
+               {
+                  err << "Expecting } but read instead " << bracket << endl;
+                  return false;
+               }
+            }
+            break;
+         case DerivationType::SOL:
+         {
+            mpq_class cutoffbound = bestObjectiveValue;
+            if (objectiveIntegral)
+            {
+               cutoffbound -= 1;
+            }
+            certificateFile >> bracket;
+            if (coef != objectiveCoefficients)
+            {
+               err << "Cutoff bound can only be applied to objective value " << endl;
+               return false;
+            }
+            else if (sense != -1)
+            {
+               err << "Cutoff bound should have sense 'L'" << endl;
+               return false;
+            }
+            else if (rhs < cutoffbound )
+            {
+               err << "No solution known with objective at most " << rhs << ", best solution is " << bestObjectiveValue << endl;
+               return false;
+            }
+            else if( bracket != "}" )
+            {
+               err << "Expecting } but read instead " << bracket << endl;
+               return false;
+            }
+            break;
+         }
+         default:
+            out << label << ": unknown derivation type " << kind << endl;
+            return false;
+            break;
+      }
+
+      // Set the list of assumptions
+      toDer.setassumptionList(assumptionList);
+
+      ++derivationsOfType[derivationType];
+      numberOfNonzeros += coef->size();
+      stats.progress(i + 1, numberOfDerivations, "derivations", out);
+
+      // Constraint hierarchy handling (??)
+      certificateFile >> refIdx;
+      toDer.setMaxRefIdx(refIdx);
+      constraint.push_back(toDer);
+
+      if( i < numberOfDerivations - 1 ) // Never trash last constraint
+         if( (refIdx >= 0) && (refIdx < int(constraint.size())) )
+         {
+             constraint.back().trash();
+         }
+
+#ifdef MORE_DEBUG_OUTPUT
+      toDer.print(out, variable);
+#endif
+   }
+
+   out << endl;
+
+   const AssumptionSet &assumptionList = constraint.back().getassumptionList();
+
+
+   // Final result
+   if( assumptionList != emptyList )
+   {
+      out << "Final derived constraint undischarged assumptions:" << endl;
+      for( auto index : assumptionList )
+         out << index << ": " << constraint[index].label() << endl;
+   }
+   else
+   {
+      if( relationToProveType == RelationToProveType::INFEAS )
+      {
+         if( constraint.back().isFalsehood() )
+         {
+            out << "Infeasibility verified." << endl;
+            returnStatement = true;
+         }
+         else
+            out << "Failed to verify infeasibility." << endl;
+      }
+      else if( (isMin && checkLower) || (!isMin && checkUpper) )
+      {
+         if( relationToProve.isTautology() )
+         {
+            out << "RTP is a tautology." << endl;
+            returnStatement = true;
+         }
+         else if( !constraint.back().dominates(relationToProve) )
+         {
+            if( isMin )
+               out << "Failed to derive lower bound." << endl;
+            else
+               out << "Failed to derive upper bound." << endl;
+            out << "Proved: " << endl;
+            constraint.back().print(out, variable);
+            out << "Instead of: " << endl;
+            relationToProve.print(out, variable);
+      }
+         else
+         {
+            if( numberOfSolutions ) {
+               out << "Best objval over all solutions: " << bestObjectiveValue << endl;
+            }
+
+            out << "Successfully verified optimal value range "
+                   << (lowerStr == "-inf" ? "(" : "[")
+                   << lowerStr << ", " << upperStr
+                   << (upperStr == "inf" ? ")" : "]")
+                   << "." << endl;
+
+            returnStatement = true;
+         }
+      }
+   }
+
+   return returnStatement;
+} // processDER
+
+
+
+// Prints how often exact arithmetic fell back from 64-bit integers to GMP
+void CertificateCheck::printArithmeticCounts()
+{
+   ArithmeticCounts total;
+   total = arithmeticCounts;
+
+   out << "Exact arithmetic: " << total.fast << " operations on 64-bit integers, "
+        << total.fallback << " fallbacks to GMP" << endl;
+}
+
+
+// Hands the counters of the check over to stats
+void CertificateCheck::collectStats(bool verified)
+{
+   stats.endPhase();
+   stats.setInfo("result", verified ? "verified" : "failed");
+   stats.set("variables", numberOfVariables);
+   stats.set("constraints", numberOfConstraints);
+   stats.set("derivations", numberOfDerivations);
+   stats.set("derivations_asm", derivationsOfType[ASM]);
+   stats.set("derivations_lin", derivationsOfType[LIN]);
+   stats.set("derivations_rnd", derivationsOfType[RND]);
+   stats.set("derivations_uns", derivationsOfType[UNS]);
+   stats.set("derivations_sol", derivationsOfType[SOL]);
+   stats.set("nonzeros", numberOfNonzeros);
+   stats.set("multipliers", numberOfMultipliers);
+   stats.set("arithmetic_fast", arithmeticCounts.fast);
+   stats.set("arithmetic_gmp_fallbacks", arithmeticCounts.fallback);
+}
+
+
+} // namespace vipr
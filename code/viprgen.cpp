@@ -0,0 +1,474 @@
+/*
+*
+*   Copyright (c) 2016 Kevin K. H. Cheung
+*   Copyright (c) 2024 Zuse Institute Berlin
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a
+*   copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation
+*   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the
+*   Software is furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in
+*   all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*   DEALINGS IN THE SOFTWARE.
+*
+*/
+
+// Generates synthetic certificates of a given shape for benchmarking the checkers and the completer
+//
+// The model has integer variables and random >= constraints with coefficients of a given bit size,
+// all satisfied by a random integer point that is written as solution. The derivations form levels:
+// every derivation of the first level combines a number of model constraints, every later one adds
+// model constraints to one derivation of the previous level. The multipliers are positive integers,
+// and the derivation of the previous level gets multiplier 1, so the coefficients grow additively
+// with the depth instead of exponentially. The last derivation adds up the last level; its left-hand
+// side is the objective, so the certificate proves its right-hand side as lower bound. A percentage of
+// the derivations can be written as incomplete, to be completed by viprcomp.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <gmpxx.h>
+#include "CMakeConfig.hpp"
+
+// Timing
+#include <sys/time.h>
+
+using namespace std;
+
+// sparse row as pairs of variable index and coefficient, sorted by index
+typedef vector<pair<int, mpq_class>> Row;
+
+// Globals
+int numberOfVariables = 1000; // number of variables
+int numberOfConstraints = 1000; // number of model constraints
+int rowSize = 10; // nonzeros per model constraint
+int depth = 10; // number of levels of derivations
+int width = 1000; // number of derivations per level
+int density = 4; // number of multipliers per derivation
+int bits = 8; // bit size of the model coefficients and of the multipliers of model constraints
+double percentageIncomplete = 0; // percentage of the derivations written as incomplete
+unsigned long long seed = 0;
+
+mt19937_64 generator; // shape of the certificate
+gmp_randclass gmpRandom(gmp_randinit_mt); // numbers of the certificate
+
+
+static double getTimeSecs(timeval start, timeval end)
+{
+   auto seconds = end.tv_sec - start.tv_sec;
+   auto microseconds = end.tv_usec - start.tv_usec;
+   auto clock_dur = seconds + microseconds*1e-6;
+   return clock_dur;
+}
+
+// Set usage options
+static void printUsage(const char* const argv[], int idx)
+{
+   const char* usage =
+      "options:\n"
+      "  --variables=<number>   number of variables (default 1000)\n"
+      "  --constraints=<number> number of model constraints (default 1000)\n"
+      "  --rowsize=<number>     nonzeros per model constraint (default 10)\n"
+      "  --depth=<number>       number of levels of derivations (default 10)\n"
+      "  --width=<number>       number of derivations per level (default 1000)\n"
+      "  --density=<number>     number of multipliers per derivation (default 4)\n"
+      "  --bits=<number>        bit size of coefficients and multipliers (default 8)\n"
+      "  --incomplete=<number>  percentage of derivations written as incomplete (default 0)\n"
+      "  --seed=<number>        seed of the random numbers (default 0)\n"
+      "\n";
+   if(idx <= 0)
+      cerr << "missing output file\n\n";
+   else
+      cerr << "invalid option \"" << argv[idx] << "\"\n\n";
+
+   cerr << "usage: " << argv[0] << " " << "[options] <certificateFile>\n"
+             << "  <certificateFile>               .vipr file to be generated\n\n"
+             << usage;
+}
+
+// nonzero integer with at most bits bits and random sign
+static mpz_class randomCoefficient()
+{
+   mpz_class value = gmpRandom.get_z_bits(bits);
+
+   if( value == 0 )
+      value = 1;
+   if( generator() & 1 )
+      value = -value;
+
+   return value;
+}
+
+// positive integer with at most bits bits
+static mpq_class randomMultiplier()
+{
+   mpz_class value = gmpRandom.get_z_bits(bits);
+
+   if( value == 0 )
+      value = 1;
+
+   return mpq_class(value);
+}
+
+// count distinct indices in [0, range), sorted
+static vector<int> randomIndices(int count, int range)
+{
+   vector<int> indices;
+
+   count = min(count, range);
+
+   // for few indices draw until distinct, otherwise shuffle all
+   if( 4 * count < range )
+   {
+      uniform_int_distribution<int> distribution(0, range - 1);
+
+      while( (int) indices.size() < count )
+      {
+         int index = distribution(generator);
+
+         if( find(indices.begin(), indices.end(), index) == indices.end() )
+            indices.push_back(index);
+      }
+   }
+   else
+   {
+      indices.resize(range);
+      for( int i = 0; i < range; ++i )
+         indices[i] = i;
+      shuffle(indices.begin(), indices.end(), generator);
+      indices.resize(count);
+   }
+
+   sort(indices.begin(), indices.end());
+   return indices;
+}
+
+// nonnegative combination of rows and right-hand sides
+// the sum is accumulated densely over the variables, only the touched entries are collected
+static vector<mpq_class> sum;
+static vector<bool> touched;
+static vector<int> touchedIndices;
+static mpq_class sumRhs;
+
+// adds multiplier times a row to the combination
+static void addToSum(const Row &row, const mpq_class &rhs, const mpq_class &multiplier)
+{
+   sum.resize(numberOfVariables);
+   touched.resize(numberOfVariables, false);
+
+   for( auto &entry : row )
+   {
+      if( !touched[entry.first] )
+      {
+         touched[entry.first] = true;
+         touchedIndices.push_back(entry.first);
+      }
+      sum[entry.first] += multiplier * entry.second;
+   }
+   sumRhs += multiplier * rhs;
+}
+
+// moves the combination to row and rhs, and starts a new one
+static void collectSum(Row &row, mpq_class &rhs)
+{
+   sort(touchedIndices.begin(), touchedIndices.end());
+
+   row.clear();
+   for( int index : touchedIndices )
+   {
+      if( sgn(sum[index]) != 0 )
+         row.push_back(make_pair(index, sum[index]));
+      sum[index] = 0;
+      touched[index] = false;
+   }
+   touchedIndices.clear();
+
+   rhs = sumRhs;
+   sumRhs = 0;
+}
+
+
+static void writeRow(ostream &out, const Row &row)
+{
+   out << row.size();
+   for( auto &entry : row )
+      out << " " << entry.first << " " << entry.second;
+}
+
+
+int main(int argc, char *argv[])
+{
+   int rs = -1;
+   const char* certificateFileName = nullptr;
+   timeval start, end;
+
+   // read arguments from command line
+   for( int optidx = 1; optidx < argc; optidx++ )
+   {
+      char* option = argv[optidx];
+      int* value = nullptr;
+
+      if( option[0] != '-' )
+      {
+         certificateFileName = option;
+         continue;
+      }
+
+      if( option[1] != '-' )
+      {
+         printUsage(argv, optidx);
+         return 1;
+      }
+
+      option = &option[2];
+
+      if( strncmp(option, "variables=", 10) == 0 )
+         value = &numberOfVariables;
+      else if( strncmp(option, "constraints=", 12) == 0 )
+         value = &numberOfConstraints;
+      else if( strncmp(option, "rowsize=", 8) == 0 )
+         value = &rowSize;
+      else if( strncmp(option, "depth=", 6) == 0 )
+         value = &depth;
+      else if( strncmp(option, "width=", 6) == 0 )
+         value = &width;
+      else if( strncmp(option, "density=", 8) == 0 )
+         value = &density;
+      else if( strncmp(option, "bits=", 5) == 0 )
+         value = &bits;
+      else if( strncmp(option, "incomplete=", 11) == 0 && isdigit(option[11]) )
+      {
+         percentageIncomplete = atof(&option[11]);
+         continue;
+      }
+      else if( strncmp(option, "seed=", 5) == 0 && isdigit(option[5]) )
+      {
+         seed = strtoull(&option[5], nullptr, 10);
+         continue;
+      }
+
+      char* str = (value == nullptr) ? nullptr : strchr(option, '=') + 1;
+
+      if( str == nullptr || !isdigit(str[0]) || atoi(str) < 1 )
+      {
+         printUsage(argv, optidx);
+         return 1;
+      }
+
+      *value = atoi(str);
+   }
+
+   if( certificateFileName == nullptr )
+   {
+      printUsage(argv, -1);
+      return 1;
+   }
+
+   gettimeofday(&start, 0);
+
+   generator.seed(seed);
+   gmpRandom.seed(seed);
+
+   // feasible point and model constraints a x >= b with a slack at the point
+   vector<long> point(numberOfVariables);
+   vector<Row> rows(numberOfConstraints);
+   vector<mpq_class> rhss(numberOfConstraints);
+   uniform_int_distribution<long> pointDistribution(-3, 3);
+   uniform_int_distribution<long> slackDistribution(0, 2);
+
+   for( auto &x : point )
+      x = pointDistribution(generator);
+
+   for( int j = 0; j < numberOfConstraints; ++j )
+   {
+      mpq_class activity = 0;
+
+      for( int index : randomIndices(rowSize, numberOfVariables) )
+      {
+         rows[j].push_back(make_pair(index, mpq_class(randomCoefficient())));
+         activity += rows[j].back().second * point[index];
+      }
+      rhss[j] = activity - slackDistribution(generator);
+   }
+
+   // the derivations are written first, the objective is only known after the last one
+   string derFileName = string(certificateFileName) + ".der";
+   ofstream derFile(derFileName.c_str());
+
+   if( derFile.fail() )
+   {
+      cerr << "Failed to open file " << derFileName << endl;
+      return rs;
+   }
+
+   vector<int> derivedParent(width, -1); // derivation of the previous level, -1 on the first level
+   vector<Row> levelRows;
+   vector<mpq_class> levelRhss;
+   Row objective;
+   mpq_class lowerBound;
+   uniform_real_distribution<double> percentage(0, 100);
+   uniform_int_distribution<int> parentDistribution(0, width - 1);
+   long numberOfIncomplete = 0;
+
+   for( int level = 1; level <= depth; ++level )
+   {
+      const int firstIdx = numberOfConstraints + (level - 1) * width;
+      const int nextFirstIdx = firstIdx + width;
+      const int numberOfModelParents = (level == 1) ? density : max(density - 1, 1);
+      vector<int> nextDerivedParent(width);
+      vector<int> lastUse(width);
+
+      // the next level is chosen first, for the maximal reference indices of this one
+      for( int j = 0; j < width; ++j )
+         lastUse[j] = firstIdx + j;
+
+      if( level < depth )
+      {
+         for( int j = 0; j < width; ++j )
+         {
+            nextDerivedParent[j] = parentDistribution(generator);
+            lastUse[nextDerivedParent[j]] = nextFirstIdx + j;
+         }
+      }
+      else
+      {
+         for( int j = 0; j < width; ++j )
+            lastUse[j] = nextFirstIdx;
+      }
+
+      vector<Row> newRows(width);
+      vector<mpq_class> newRhss(width);
+
+      for( int j = 0; j < width; ++j )
+      {
+         vector<int> modelParents = randomIndices(numberOfModelParents, numberOfConstraints);
+         vector<mpq_class> multipliers(modelParents.size());
+
+         for( size_t k = 0; k < modelParents.size(); ++k )
+         {
+            multipliers[k] = randomMultiplier();
+            addToSum(rows[modelParents[k]], rhss[modelParents[k]], multipliers[k]);
+         }
+         if( derivedParent[j] >= 0 )
+            addToSum(levelRows[derivedParent[j]], levelRhss[derivedParent[j]], 1);
+
+         collectSum(newRows[j], newRhss[j]);
+
+         derFile << "D" << level << "_" << j << " G " << newRhss[j] << " ";
+         writeRow(derFile, newRows[j]);
+
+         if( percentage(generator) < percentageIncomplete )
+         {
+            // only the active derivations are listed, the model constraints are always available
+            derFile << " { lin incomplete";
+            if( derivedParent[j] >= 0 )
+               derFile << " " << firstIdx - width + derivedParent[j];
+            ++numberOfIncomplete;
+         }
+         else
+         {
+            derFile << " { lin " << modelParents.size() + (derivedParent[j] >= 0 ? 1 : 0);
+            for( size_t k = 0; k < modelParents.size(); ++k )
+               derFile << " " << modelParents[k] << " " << multipliers[k];
+            if( derivedParent[j] >= 0 )
+               derFile << " " << firstIdx - width + derivedParent[j] << " 1";
+         }
+         derFile << " } " << lastUse[j] << "\n";
+      }
+
+      levelRows.swap(newRows);
+      levelRhss.swap(newRhss);
+      derivedParent.swap(nextDerivedParent);
+   }
+
+   // sum of the last level
+   {
+      const int firstIdx = numberOfConstraints + (depth - 1) * width;
+
+      for( int j = 0; j < width; ++j )
+         addToSum(levelRows[j], levelRhss[j], 1);
+
+      collectSum(objective, lowerBound);
+
+      derFile << "bound G " << lowerBound << " OBJ { lin " << width;
+      for( int j = 0; j < width; ++j )
+         derFile << " " << firstIdx + j << " 1";
+      derFile << " } -1\n";
+   }
+
+   derFile.close();
+
+   ofstream certificateFile(certificateFileName);
+
+   if( certificateFile.fail() )
+   {
+      cerr << "Failed to open file " << certificateFileName << endl;
+      return rs;
+   }
+
+   certificateFile << "% synthetic certificate: variables " << numberOfVariables << " constraints " << numberOfConstraints
+                   << " rowsize " << rowSize << " depth " << depth << " width " << width << " density " << density
+                   << " bits " << bits << " incomplete " << percentageIncomplete << " seed " << seed << "\n";
+   certificateFile << "VER 1.1\nVAR " << numberOfVariables << "\n";
+   for( int i = 0; i < numberOfVariables; ++i )
+      certificateFile << "x" << i << (i + 1 < numberOfVariables ? " " : "\n");
+   certificateFile << "INT " << numberOfVariables << "\n";
+   for( int i = 0; i < numberOfVariables; ++i )
+      certificateFile << i << (i + 1 < numberOfVariables ? " " : "\n");
+
+   certificateFile << "OBJ min\n";
+   writeRow(certificateFile, objective);
+   certificateFile << "\nCON " << numberOfConstraints << " 0\n";
+   for( int j = 0; j < numberOfConstraints; ++j )
+   {
+      certificateFile << "C" << j << " G " << rhss[j] << " ";
+      writeRow(certificateFile, rows[j]);
+      certificateFile << "\n";
+   }
+
+   certificateFile << "RTP range " << lowerBound << " inf\nSOL 1\npoint ";
+   {
+      Row solution;
+
+      for( int i = 0; i < numberOfVariables; ++i )
+         if( point[i] != 0 )
+            solution.push_back(make_pair(i, mpq_class(point[i])));
+      writeRow(certificateFile, solution);
+   }
+   certificateFile << "\nDER " << depth * width + 1 << "\n";
+
+   ifstream derInput(derFileName.c_str());
+   certificateFile << derInput.rdbuf();
+   derInput.close();
+   std::remove(derFileName.c_str());
+
+   certificateFile.close();
+
+   if( certificateFile.fail() )
+   {
+      cerr << "Failed to write " << certificateFileName << endl;
+      return rs;
+   }
+
+   gettimeofday(&end, 0);
+   cout << "Generated " << certificateFileName << " with " << depth * width + 1 << " derivations ("
+        << numberOfIncomplete << " incomplete) in " << getTimeSecs(start, end) << " seconds (Wall Clock)" << endl;
+
+   rs = 0;
+   return rs;
+}
@@ -23,11 +23,19 @@
 *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <vector>
 #include <functional>
 #include "CMakeConfig.hpp"
+#include "tokenizer.hpp"
+
+// Parallelization
+#include <tbb/tbb.h>
 
 using namespace std;
 
@@ -42,13 +50,17 @@ class Node {
  public:
    vector<int> neededBy;
    vector<int> needs;
-   streampos fpos;
+   string text; // tokens of the derivation separated by single spaces
    Mark mark = NONE;
    int newIdx = -1;
 };
 
-bool firstPass( ifstream &pf, int &numCon, vector<Node> &nodes, streampos &fposDer );
-bool writeReorderedDER( ifstream &pf, ofstream &optF, streampos fposDer, int &numCon, vector<Node> &nodes, vector<int> &L );
+bool firstPass( Tokenizer &pf, int &numCon, vector<Node> &nodes, streampos &fposDer );
+bool writeReorderedDER( Tokenizer &pf, ofstream &optF, streampos fposDer, int &numCon, vector<Node> &nodes, vector<int> &L );
+bool readDerivation( Tokenizer &pf, string &text );
+bool readDependencies( const string &text, int numCon, int numDer, int derIdx, vector<int> &needs,
+                       string &error );
+void writeDerivation( const string &text, int numCon, const vector<Node> &nodes, int derIdx, string &out );
 
 int main(int argc, char *argv[])
 {
@@ -56,7 +68,7 @@ int main(int argc, char *argv[])
    bool stat = false;
    int numCon;
 
-   ifstream pf; // input vipr file
+   Tokenizer pf; // input vipr file
    streampos fposDer = -1;
    ofstream optF; // optimized vipr file
 
@@ -65,10 +77,21 @@ int main(int argc, char *argv[])
 
    int rs = -1;
    int farg = 1;
+   bool reorder = true; // sort derivations topologically, otherwise only remove unused ones
 
-   if( argc != 2 )
+   if( argc == 3 && strcmp( argv[1], "--reorder=off" ) == 0 )
    {
-      cerr << "Usage: " << argv[0] << " filename\n" << endl;
+      reorder = false;
+      farg = 2;
+   }
+   else if( argc == 3 && strcmp( argv[1], "--reorder=on" ) == 0 )
+      farg = 2;
+
+   if( argc != farg + 1 )
+   {
+      cerr << "Usage: " << argv[0] << " [--reorder=on/off] filename\n" << endl;
+      cerr << "  --reorder=off   keep the order of the derivations and only remove the ones" << endl
+           << "                  that the last derivation does not depend on" << endl;
       return rs;
    }
 
@@ -81,8 +104,14 @@ int main(int argc, char *argv[])
       return rs;
    }
 
+   if( pf.isBinary() )
+   {
+      cerr << "Binary certificates are not supported, convert " << argv[farg] << " with bin2vipr first" << endl;
+      return rs;
+   }
+
 
-   string optFname = string(argv[farg]) + ".opt";
+   string optFname = stripCompressionSuffix(argv[farg]) + ".opt";
 
    optF.open( optFname.c_str());
 
@@ -99,7 +128,7 @@ int main(int argc, char *argv[])
    for( size_t i = 0; i < nodes.size(); ++i )
    {
       cout << "Node " << i << endl;
-      cout << "  fpos = " << nodes[i].fpos << endl;
+      cout << "  text = " << nodes[i].text << endl;
       cout << "  needed by: ";
       for( auto it : nodes[i].neededBy )
           cout << it << " ";
@@ -141,6 +170,19 @@ int main(int argc, char *argv[])
 
       if( stat )
       {
+         // every derivation only depends on earlier ones, so the original order is topological, too
+         if( !reorder )
+            sort( L.begin(), L.end() );
+
+         size_t removedBytes = 0;
+         for( auto &node : nodes )
+         {
+            if( node.mark != PERM ) removedBytes += node.text.size();
+         }
+
+         cout << "Removed " << nodes.size() - L.size() << " of " << nodes.size() << " derivations ("
+              << removedBytes << " bytes) that the last derivation does not depend on" << endl;
+
          for( size_t i = 0; i < L.size(); ++i )
          {
              nodes[ L[i] ].newIdx = i;
@@ -183,11 +225,10 @@ TERMINATE:
 // constraints and outputs the vipr file up to right before DER.
 // returns the file position right after numDer.
 // returns -1 if an error has occurred.
-bool firstPass( ifstream &pf, int &numCon, vector<Node> &nodes, streampos &fposDer )
+bool firstPass( Tokenizer &pf, int &numCon, vector<Node> &nodes, streampos &fposDer )
 {
    string section, tmp, label;
    char sense;
-   int con1, asm1, con2, asm2; // for reading unsplitting indices
    int numBnd, numSol, numDer, idx, num;
    bool stat = false;
 
@@ -240,96 +281,6 @@ bool firstPass( ifstream &pf, int &numCon, vector<Node> &nodes, streampos &fposD
       return rval;
    };
 
-   auto _processLinCombSparseVec = [ &pf, &numCon, &nodes ]( int derConIdx )
-   {
-      bool rval = true;
-
-      string input, val, tmp;
-      int k, index;
-
-      pf >> tmp;
-
-      if( tmp == "weak" )
-      {
-         // forward until we hit linear derivation
-         while( tmp != "}" )
-         {
-            pf >> tmp;
-         }
-         pf >> k;
-         if( pf.fail() )
-         {
-            cerr << "Failed to read number of coefficients" << endl;
-            rval = false;
-         }
-         else
-         {
-            for( int i = 0; i < k; ++i )
-            {
-               pf >> index >> val;
-               if( pf.fail() )
-               {
-                  cerr << "Failed reading coefficient " << i << endl;
-                  rval = false;
-                  break;
-               }
-               else if( index >= numCon )
-               {
-                  index -= numCon;
-                  nodes[ derConIdx ].needs.push_back( index );
-                  nodes[ index ].neededBy.push_back( derConIdx );
-               }
-            }
-         }
-      }
-      else if( tmp == "incomplete")
-      {
-         pf >> tmp;
-         while( tmp != "}" )
-         {
-            index = atoi(tmp.c_str());
-            if( index >= numCon )
-            {
-               index -= numCon;
-               nodes[ derConIdx ].needs.push_back( index );
-               nodes[ index ].neededBy.push_back( derConIdx );
-            }
-            pf >> tmp;
-         }
-         pf.putback( '}' );
-      }
-      else
-      {
-         k = atoi(tmp.c_str());
-         if( pf.fail() )
-         {
-            cerr << "Failed to read number of coefficients" << endl;
-            rval = false;
-         }
-         else
-         {
-            for( int i = 0; i < k; ++i )
-            {
-               pf >> index >> val;
-               if( pf.fail() )
-               {
-                  cerr << "Failed reading coefficient " << i << endl;
-                  rval = false;
-            break;
-               }
-               else if( index >= numCon )
-               {
-                  index -= numCon;
-                  nodes[ derConIdx ].needs.push_back( index );
-                  nodes[ index ].neededBy.push_back( derConIdx );
-               }
-            }
-         }
-      }
-      return rval;
-   };
-
-
    // Eat up comment lines, if any, until hitting VER
    for(;;)
    {
@@ -494,122 +445,81 @@ bool firstPass( ifstream &pf, int &numCon, vector<Node> &nodes, streampos &fposD
 
    nodes.resize( numDer );
 
-   for(auto i = 0; i < numDer; ++i )
+   // derivations are read sequentially in chunks, and the dependencies of each chunk are
+   // extracted in parallel
    {
-
-      nodes[i].fpos = pf.tellg();
-
-      pf >> label >> sense >> tmp;
-
-      if( pf.fail() )
+      struct Chunk
       {
-         cerr << "Error reading " << i << " " << label << endl;
-         goto TERMINATE;
-      }
+         int begin;
+         int end;
+         int errorIdx; // first derivation with an error, numDer if there is none
+         string error;
+      };
 
-      stat = _processSparseVec(); // just eat up the derived constraint
-      if( !stat )
-      {
-         cerr << "Error processing " << label << endl;
-         goto TERMINATE;
-      }
+      const int chunkSize = 1024;
+      int numRead = 0;
+      atomic<bool> failed( false );
+      string error;
 
-      pf >> tmp;
+      tbb::parallel_pipeline( 2 * tbb::this_task_arena::max_concurrency(),
+         tbb::make_filter<void, Chunk>( tbb::filter_mode::serial_in_order,
+            [&]( tbb::flow_control &fc )
+            {
+               Chunk chunk{ numRead, numRead, numDer, "" };
 
-      if( pf.fail() )
-      {
-         cerr << "Error reading reason for " << label << endl;
-         goto TERMINATE;
-      }
+               if( numRead == numDer || failed )
+               {
+                  fc.stop();
+                  return chunk;
+               }
 
-      if( tmp != "{" )
-      {
-         cerr << "'{' expected.   Reading instead: " << tmp << " in "
-              << label << endl;
-         goto TERMINATE;
-      }
-      else
-      {
-         pf >> tmp;
-         if( pf.fail() )
-         {
-            cerr << "Error reading reason type for " << label << endl;
-            goto TERMINATE;
-         }
-         if( tmp == "asm" || tmp == "sol" )
-         {
-            pf >> tmp;
-            if( tmp != "}")
-            {
-               cerr << "'}' expected. Read instead: " << tmp << endl;
-               goto TERMINATE;
-            }
-         }
-         else if( tmp == "lin" )
-         {
-            stat = _processLinCombSparseVec( i );
-            if( stat )
-            {
-               pf >> tmp;
-               if( tmp != "}")
+               while( chunk.end < numDer && chunk.end - chunk.begin < chunkSize )
                {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
+                  if( !readDerivation( pf, nodes[ chunk.end ].text ) )
+                  {
+                     chunk.errorIdx = chunk.end;
+                     chunk.error = "Error reading derivation " + to_string( chunk.end );
+                     break;
+                  }
+                  ++chunk.end;
                }
-            }
-         }
-         else if( tmp == "rnd" )
-         {
-            stat = _processLinCombSparseVec( i );
-            if( stat )
+
+               numRead = ( chunk.errorIdx < numDer ) ? numDer : chunk.end;
+               return chunk;
+            } ) &
+         tbb::make_filter<Chunk, Chunk>( tbb::filter_mode::parallel,
+            [&]( Chunk chunk )
             {
-               pf >> tmp;
-               if( tmp != "}")
+               for( int i = chunk.begin; i < chunk.end && i < chunk.errorIdx; ++i )
                {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
+                  if( !readDependencies( nodes[i].text, numCon, numDer, i, nodes[i].needs, chunk.error ) )
+                     chunk.errorIdx = i;
                }
-            }
-         }
-         else if( tmp == "uns" )
-         {
-            pf >> con1 >> asm1 >> con2 >> asm2;
-            if( pf.fail() )
-            {
-               cerr << "Error reading unsplit indices for " << label << endl;
-               goto TERMINATE;
-            }
-            else
+               return chunk;
+            } ) &
+         tbb::make_filter<Chunk, void>( tbb::filter_mode::serial_in_order,
+            [&]( Chunk chunk )
             {
+               if( failed ) return;
 
-               auto _insertArc = [ &nodes ](int tail, int head)
+               for( int i = chunk.begin; i < chunk.end && i < chunk.errorIdx; ++i )
                {
-                   nodes[ tail ].neededBy.push_back( head );
-                   nodes[ head ].needs.push_back( tail );
-               };
-               if( con1 >= numCon ) _insertArc( con1 - numCon, i );
-               if( con2 >= numCon ) _insertArc( con2 - numCon, i );
-               if( asm1 >= numCon ) _insertArc( asm1 - numCon, i );
-               if( asm2 >= numCon ) _insertArc( asm2 - numCon, i );
-
-               pf >> tmp;
-               if( tmp != "}")
+                  for( auto m : nodes[i].needs )
+                     nodes[m].neededBy.push_back( i );
+               }
+
+               if( chunk.errorIdx < numDer )
                {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
+                  error = chunk.error;
+                  failed = true;
                }
-            }
-         }
-         else
-         {
-            cerr << "Unrecognized reason type: " << tmp << endl;
-            goto TERMINATE;
-         }
+            } ) );
 
+      if( failed )
+      {
+         cerr << error << endl;
+         goto TERMINATE;
       }
-
-      pf >> idx; // read off current max con index and ignore it
-
    }
 
    stat = true;
@@ -620,281 +530,388 @@ TERMINATE:
    return stat;
 }
 
-bool writeReorderedDER( ifstream &pf, ofstream &optF, streampos fposDer, int &numCon, vector<Node> &nodes, vector<int> &L )
+// reads the space separated tokens of a derivation that is held in memory
+class TokenCursor
 {
-   string section, tmp, label;
-   char sense;
-   int con1, asm1, con2, asm2; // for reading unsplitting indices
-   bool stat = false;
+ public:
+   TokenCursor( const string &text ) : _cur( text.c_str() ), _end( text.c_str() + text.size() ) {}
 
-   auto _processSparseVec = [ &pf, &optF, &numCon, &nodes ]( bool useNewIdx )
+   bool next( string &token )
    {
-      bool rval = true;
+      while( _cur < _end && *_cur == ' ' ) ++_cur;
 
-      string input, val;
-      int k, index;
+      const char* start = _cur;
+      while( _cur < _end && *_cur != ' ' ) ++_cur;
 
-      pf >> input;
-      if (input == "OBJ")
-      {
-         optF << " OBJ ";
-      }
-      else
-      {
-         if(input == "weak")
-         {
-            // pass over the weak derivation
-            optF << " weak ";
-            while( input != "}" )
-            {
-               pf >> input;
-               optF << " " << input;
-            }
+      token.assign( start, _cur - start );
+      if( token.empty() ) _fail = true;
+      return !_fail;
+   }
 
-            // now read the linear derivation
-            pf >> k;
+   bool fail() const { return _fail; }
 
-            optF << " " << k;
+ private:
+   const char* _cur;
+   const char* _end;
+   bool _fail = false;
+};
 
-            for( int i = 0; i < k; ++i )
-            {
-               pf >> index >> val;
-               if( pf.fail() )
-               {
-                  cerr << "Failed reading coefficient " << i << endl;
-                  rval = false;
-            break;
-               }
-               else
-               {
-                  // if ( (i+1) % 20 == 0) optF << endl;
+// reads one derivation from the file; its tokens are stored separated by single spaces
+// the derivation ends with the index after the closing brace of its reason
+bool readDerivation( Tokenizer &pf, string &text )
+{
+   TokenView token;
+   int depth = 0;
+   bool inReason = false;
 
-                  if( useNewIdx && index >= numCon )
-                  {
-                     index -= numCon;
-                     index = nodes[ index ].newIdx + numCon;
-                  }
+   text.clear();
 
-                  optF << "  " << index << " " << val;
-               }
-            }
-         }
-         else if(input == "incomplete")
-         {
-            optF << " incomplete ";
-            while(input != "}")
-            {
-               pf >> input;
-               if(input != "}")
-               {
-                  index = atoi(input.c_str());
-                  if( useNewIdx && index >= numCon )
-                  {
-                     index -= numCon;
-                     index = nodes[ index ].newIdx + numCon;
-                  }
+   while( pf.nextToken( token ) )
+   {
+      if( !text.empty() ) text += ' ';
+      text.append( token.data, token.size );
 
-                  optF << "  " << index;
-               }
-            }
-            pf.putback( '}' );
-         }
-         else
-         {
-            k = atoi(input.c_str());
+      if( inReason && depth == 0 ) return true;
 
-            optF << " " << k;
+      if( token == "{" )
+      {
+         ++depth;
+         inReason = true;
+      }
+      else if( token == "}" )
+         --depth;
+   }
 
-            for( int i = 0; i < k; ++i )
-            {
-               pf >> index >> val;
-               if( pf.fail() )
-               {
-                  cerr << "Failed reading coefficient " << i << endl;
-                  rval = false;
-            break;
-               }
-               else
-               {
-                  // if ( (i+1) % 20 == 0) optF << endl;
+   return false;
+}
 
-                  if( useNewIdx && index >= numCon )
-                  {
-                     index -= numCon;
-                     index = nodes[ index ].newIdx + numCon;
-                  }
+// extracts the derivations that derivation derIdx needs, checking the format on the way
+bool readDependencies( const string &text, int numCon, int numDer, int derIdx, vector<int> &needs,
+                       string &error )
+{
+   TokenCursor cur( text );
+   string label, sense, tmp, val;
+   int k;
+   bool rval = false;
 
-                  optF << "  " << index << " " << val;
-               }
-            }
+   auto _addNeed = [ &needs, &numCon, &numDer, &error, &label ]( int index )
+   {
+      if( index >= numCon )
+      {
+         if( index - numCon >= numDer )
+         {
+            error = "Index " + to_string( index ) + " out of range in " + label;
+            return false;
          }
+         needs.push_back( index - numCon );
       }
-      return rval;
+      return true;
    };
 
+   auto _readLinComb = [ &cur, &tmp, &val, &k, &_addNeed, &error ]()
+   {
+      cur.next( tmp );
+      if( tmp == "incomplete" )
+      {
+         // the closing brace of the active derivations also closes the reason
+         while( cur.next( tmp ) && tmp != "}" )
+         {
+            if( !_addNeed( atoi( tmp.c_str() ) ) ) return false;
+         }
+         return !cur.fail();
+      }
+      else if( tmp == "weak" )
+      {
+         // forward until we hit linear derivation
+         while( cur.next( tmp ) && tmp != "}" );
+         cur.next( tmp );
+      }
 
-   pf.seekg( 0 );
-   // copy up to fposDer
-   auto inStream = istreambuf_iterator<char>(pf);
-   auto outStream = ostreambuf_iterator<char>(optF);
+      k = atoi( tmp.c_str() );
+
+      if( cur.fail() )
+      {
+         error = "Failed to read number of coefficients";
+         return false;
+      }
 
-   for(int i = 0; i < fposDer; ++i)
+      for( int i = 0; i < k; ++i )
+      {
+         cur.next( tmp );
+         cur.next( val );
+         if( cur.fail() )
+         {
+            error = "Failed reading coefficient " + to_string( i );
+            return false;
+         }
+         if( !_addNeed( atoi( tmp.c_str() ) ) ) return false;
+      }
+
+      cur.next( tmp );
+      if( tmp != "}" )
+      {
+         error = "'}' expected. Read instead: " + tmp;
+         return false;
+      }
+      return true;
+   };
+
+   cur.next( label );
+   cur.next( sense );
+   cur.next( tmp );
+
+   if( cur.fail() || sense.size() != 1 )
    {
-      *outStream++ = *inStream++;
+      error = "Error reading " + to_string( derIdx ) + " " + label;
+      goto TERMINATE;
    }
 
-   // copy_n(istreambuf_iterator<char>(pf), fposDer, ostreambuf_iterator<char>(optF));  This doesn't compile in Ubuntu!!!
-
-   cout << "NDER = " << L.size() << endl;
+   // just eat up the derived constraint
+   cur.next( tmp );
+   if( tmp != "OBJ" )
+   {
+      k = atoi( tmp.c_str() );
+      for( int i = 0; i < 2 * k; ++i ) cur.next( tmp );
+   }
 
-   optF << " " << L.size() << endl;
+   if( cur.fail() )
+   {
+      error = "Error processing " + label;
+      goto TERMINATE;
+   }
 
-   for(auto i : L )
+   cur.next( tmp );
+   if( tmp != "{" )
    {
+      error = "'{' expected.   Reading instead: " + tmp + " in " + label;
+      goto TERMINATE;
+   }
 
-      pf.seekg( nodes[ i ].fpos );
+   cur.next( tmp );
+   if( cur.fail() )
+   {
+      error = "Error reading reason type for " + label;
+      goto TERMINATE;
+   }
 
-      pf >> label >> sense >> tmp;
-      if( pf.fail() )
+   if( tmp == "asm" || tmp == "sol" )
+   {
+      cur.next( tmp );
+      if( tmp != "}" )
       {
-         cerr << "Error reading " << label << " " << i << endl;
+         error = "'}' expected. Read instead: " + tmp;
          goto TERMINATE;
       }
+   }
+   else if( tmp == "lin" || tmp == "rnd" )
+   {
+      if( !_readLinComb() ) goto TERMINATE;
+   }
+   else if( tmp == "uns" )
+   {
+      int unsIdx[4]; // con1 asm1 con2 asm2
 
-      optF << label << " " << sense << " " << tmp;
+      for( int i = 0; i < 4; ++i )
+      {
+         cur.next( tmp );
+         unsIdx[i] = atoi( tmp.c_str() );
+      }
 
-      stat = _processSparseVec( false );
-      if( !stat )
+      if( cur.fail() )
       {
-         cerr << "Error processing " << label << endl;
+         error = "Error reading unsplit indices for " + label;
          goto TERMINATE;
       }
 
-      pf >> tmp;
-      if( pf.fail() )
+      if( !_addNeed( unsIdx[0] ) || !_addNeed( unsIdx[2] ) || !_addNeed( unsIdx[1] ) || !_addNeed( unsIdx[3] ) )
+         goto TERMINATE;
+
+      cur.next( tmp );
+      if( tmp != "}" )
       {
-         cerr << "Error reading reason for " << label << endl;
+         error = "'}' expected. Read instead: " + tmp;
          goto TERMINATE;
       }
+   }
+   else
+   {
+      error = "Unrecognized reason type: " + tmp;
+      goto TERMINATE;
+   }
+
+   cur.next( tmp ); // current max con index is ignored
+   if( cur.fail() )
+   {
+      error = "Error reading max reference index for " + label;
+      goto TERMINATE;
+   }
 
-      optF << " " << tmp;
+   rval = true;
 
-      if( tmp != "{" )
+TERMINATE:
+   return rval;
+}
+
+// appends derivation derIdx to out, using the new indices of the derivations it needs
+// its max reference index is the new index of its last use
+void writeDerivation( const string &text, int numCon, const vector<Node> &nodes, int derIdx, string &out )
+{
+   TokenCursor cur( text );
+   string tmp, val;
+   int k;
+
+   auto _newIdx = [ &nodes, &numCon ]( int idx )
+   {
+      if( idx >= numCon ) idx = nodes[ idx - numCon ].newIdx + numCon;
+      return idx;
+   };
+
+   // returns true if the closing brace of the reason has been read as well
+   auto _writeSparseVec = [ &cur, &tmp, &val, &k, &out, &_newIdx ]( bool useNewIdx )
+   {
+      cur.next( tmp );
+      if( tmp == "OBJ" )
       {
-         cerr << "'{' expected.   Reading instead: " << tmp << " in "
-              << label << endl;
-         goto TERMINATE;
+         out += " OBJ ";
+         return false;
       }
-      else
+      else if( tmp == "incomplete" )
       {
-         pf >> tmp;
-         if( pf.fail() )
-         {
-            cerr << "Error reading reason type for " << label << endl;
-            goto TERMINATE;
-         }
-
-         optF << " " << tmp;
-         if( tmp == "asm" || tmp == "sol" )
+         out += " incomplete ";
+         while( cur.next( tmp ) && tmp != "}" )
          {
-            pf >> tmp;
-            if( tmp != "}")
-            {
-               cerr << "'}' expected. Read instead: " << tmp << endl;
-               goto TERMINATE;
-            }
-            optF << " " << tmp;
+            int index = atoi( tmp.c_str() );
+            out += "  " + to_string( useNewIdx ? _newIdx( index ) : index );
          }
-         else if( tmp == "lin" )
+         return true;
+      }
+      else if( tmp == "weak" )
+      {
+         // pass over the weak derivation
+         out += " weak ";
+         while( cur.next( tmp ) )
          {
-            stat = _processSparseVec( true );
-            if( stat )
-            {
-               pf >> tmp;
-               if( tmp != "}")
-               {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
-               }
-               optF << " " << tmp;
-            }
+            out += " " + tmp;
+            if( tmp == "}" ) break;
          }
-         else if( tmp == "rnd" )
-         {
-            stat = _processSparseVec( true );
-            if( stat )
-            {
-               pf >> tmp;
-               if( tmp != "}")
-               {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
-               }
-               optF << " " << tmp;
-            }
-         }
-         else if( tmp == "uns" )
-         {
-            pf >> con1 >> asm1 >> con2 >> asm2;
-            if( pf.fail() )
-            {
-               cerr << "Error reading unsplit indices for " << label << endl;
-               goto TERMINATE;
-            }
-            else
-            {
+         cur.next( tmp );
+      }
 
-               auto _printNewIdx = [ &nodes, &optF, &numCon ](int idx)
-               {
-                   if( idx >= numCon ) idx = nodes[idx - numCon].newIdx + numCon;
-                   optF << " " << idx;
-               };
-               _printNewIdx( con1 );
-               _printNewIdx( asm1 );
-               _printNewIdx( con2 );
-               _printNewIdx( asm2 );
-
-               pf >> tmp;
-               if( tmp != "}")
-               {
-                  cerr << "'}' expected. Read instead: " << tmp << endl;
-                  goto TERMINATE;
-               }
-               optF << " " << tmp;
-            }
-         }
-         else
-         {
-            cerr << "Unrecognized reason type: " << tmp << endl;
-            goto TERMINATE;
-         }
+      k = atoi( tmp.c_str() );
+      out += " " + to_string( k );
+
+      for( int i = 0; i < k; ++i )
+      {
+         cur.next( tmp );
+         cur.next( val );
 
+         int index = atoi( tmp.c_str() );
+         out += "  " + to_string( useNewIdx ? _newIdx( index ) : index ) + " " + val;
       }
+      return false;
+   };
 
-      pf >> tmp; // read off current max con index and ignore it
+   // label, sense and rhs
+   for( int i = 0; i < 3; ++i )
+   {
+      cur.next( tmp );
+      if( i ) out += " ";
+      out += tmp;
+   }
+
+   _writeSparseVec( false );
+
+   cur.next( tmp ); // {
+   out += " " + tmp;
+
+   cur.next( tmp );
+   out += " " + tmp;
 
-      auto _maxIdx = [ &nodes, &numCon ](int m)
+   if( tmp == "lin" || tmp == "rnd" )
+   {
+      if( _writeSparseVec( true ) )
+         tmp = "}";
+      else
+         cur.next( tmp );
+      out += " " + tmp;
+   }
+   else if( tmp == "uns" )
+   {
+      for( int i = 0; i < 4; ++i )
       {
-         int maxIdx = -1;
-         for( auto n : nodes[m].neededBy )
-         {
-            int newIdx = nodes[n].newIdx;
-            if( newIdx > maxIdx ) maxIdx = newIdx;
+         cur.next( tmp );
+         out += " " + to_string( _newIdx( atoi( tmp.c_str() ) ) );
+      }
+      cur.next( tmp );
+      out += " " + tmp;
+   }
+   else
+   {
+      // asm and sol
+      cur.next( tmp );
+      out += " " + tmp;
+   }
 
-         }
-         if (maxIdx != -1) maxIdx += numCon;
-         return maxIdx;
-      };
+   int maxIdx = -1;
+   for( auto n : nodes[ derIdx ].neededBy )
+   {
+      if( nodes[n].newIdx > maxIdx ) maxIdx = nodes[n].newIdx;
+   }
+   if( maxIdx != -1 ) maxIdx += numCon;
+
+   out += " " + to_string( maxIdx ) + "\n";
+}
 
-      optF << " " << _maxIdx( i ) << endl;
+bool writeReorderedDER( Tokenizer &pf, ofstream &optF, streampos fposDer, int &numCon, vector<Node> &nodes, vector<int> &L )
+{
+   const size_t chunkSize = 1024;
+   size_t numWritten = 0;
+   bool stat = false;
+
+   pf.clear();
+   pf.seekg( 0 );
+   // copy up to fposDer
+   pf.copyTo( optF, fposDer );
 
+   if( pf.fail() )
+   {
+      cerr << "Failed to copy the certificate up to DER" << endl;
+      goto TERMINATE;
    }
 
-   stat = true;
+   cout << "NDER = " << L.size() << endl;
+
+   optF << " " << L.size() << endl;
+
+   // the derivations are formatted in parallel chunks of the new order and written sequentially
+   tbb::parallel_pipeline( 2 * tbb::this_task_arena::max_concurrency(),
+      tbb::make_filter<void, pair<size_t, size_t>>( tbb::filter_mode::serial_in_order,
+         [&]( tbb::flow_control &fc )
+         {
+            pair<size_t, size_t> range( numWritten, min( numWritten + chunkSize, L.size() ) );
+
+            if( numWritten == L.size() ) fc.stop();
+            numWritten = range.second;
+            return range;
+         } ) &
+      tbb::make_filter<pair<size_t, size_t>, string>( tbb::filter_mode::parallel,
+         [&]( pair<size_t, size_t> range )
+         {
+            string out;
+            for( size_t j = range.first; j < range.second; ++j )
+               writeDerivation( nodes[ L[j] ].text, numCon, nodes, L[j], out );
+            return out;
+         } ) &
+      tbb::make_filter<string, void>( tbb::filter_mode::serial_in_order,
+         [&]( const string &out )
+         {
+            optF << out;
+         } ) );
+
+   stat = !optF.fail();
 
 
 TERMINATE:
 
    return stat;
 }
-